@@ -0,0 +1,73 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BlueprintDataDefinitions.h"
+#include "AdvancedSessionsCacheSubsystem.generated.h"
+
+class UFindSessionsCallbackProxyAdvanced;
+
+// Results of one normalized session query
+struct FAdvancedSessionsCacheEntry
+{
+	TArray<FBlueprintSessionResult> Results;
+
+	// FPlatformTime::Seconds() of the search that produced the results
+	double Time = 0.0;
+};
+
+// Keeps the results of FindSessionsAdvanced queries for the lifetime of the game instance
+// Queries with a CacheTimeToLive get fresh results back without a backend query, stale results are returned as well and refreshed in the background
+// A search that has to go to the backend cancels the background refreshes, most subsystems ignore a second search while one is in flight
+UCLASS(Config = Game)
+class ADVANCEDSESSIONS_API UAdvancedSessionsCacheSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Results older than this are dropped instead of returned, the query then runs in the foreground
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Online|AdvancedSessions|Cache")
+	float MaxStaleAge = 300.f;
+
+	// Background searches running longer than this are cancelled, their query is dropped so the next search of it runs in the foreground
+	UPROPERTY(Config, EditAnywhere, BlueprintReadWrite, Category = "Online|AdvancedSessions|Cache")
+	float RefreshTimeout = 30.f;
+
+	// Drops every cached result, the next search of each query goes to the backend
+	UFUNCTION(BlueprintCallable, Category = "Online|AdvancedSessions|Cache")
+	void InvalidateSessionsCache();
+
+	virtual void Deinitialize() override;
+
+	// Returns the cached entry of a query unless it is older than MaxStaleAge
+	const FAdvancedSessionsCacheEntry* FindEntry(const FString& Key) const;
+
+	void StoreResults(const FString& Key, const TArray<FBlueprintSessionResult>& Results);
+
+	// Re-runs the query of Request with its results going into the cache only, a query is never refreshed twice at once
+	void RefreshInBackground(const FString& Key, const UFindSessionsCallbackProxyAdvanced* Request);
+
+	void OnRefreshCompleted(UFindSessionsCallbackProxyAdvanced* Proxy);
+
+	bool IsRefreshing() const { return RefreshProxies.Num() > 0; }
+
+	// Cancels every background search so a foreground search gets the session interface right away, their cached results stay
+	void CancelRefreshes();
+
+private:
+	// Cancels background searches older than RefreshTimeout
+	bool ExpireRefreshes(float DeltaTime);
+
+	TMap<FString, FAdvancedSessionsCacheEntry> Entries;
+
+	// Background searches in flight, held here as nothing else references them
+	UPROPERTY()
+	TArray<UFindSessionsCallbackProxyAdvanced*> RefreshProxies;
+
+	// FPlatformTime::Seconds() each refresh started at, parallel to RefreshProxies
+	TArray<double> RefreshStartTimes;
+
+	FTSTicker::FDelegateHandle ExpireTickerHandle;
+};
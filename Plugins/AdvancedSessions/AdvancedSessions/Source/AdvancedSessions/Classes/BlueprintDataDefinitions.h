@@ -107,6 +107,20 @@ enum class EBPServerPresenceSearchType : uint8
 	DedicatedServersOnly
 };
 
+// What client side session sorting orders by
+UENUM(BlueprintType)
+enum class EBPSessionSortKey : uint8
+{
+	// Keep the order of the results
+	None,
+	Ping,
+	PlayerCount,
+	// An Int32 extra setting, read like GetSessionPropertyInt
+	ExtraSettingInt,
+	// A Float extra setting, read like GetSessionPropertyFloat
+	ExtraSettingFloat
+};
+
 // Wanted this to be switchable in the editor
 UENUM(BlueprintType)
 enum class EBPOnlinePresenceState : uint8
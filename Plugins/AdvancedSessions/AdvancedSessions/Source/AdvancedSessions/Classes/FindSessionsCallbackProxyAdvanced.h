@@ -1,17 +1,56 @@
 // Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
 #pragma once
 #include "CoreMinimal.h"
+#include "Containers/Ticker.h"
 #include "Engine/Engine.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "FindSessionsCallbackProxy.h"
 #include "BlueprintDataDefinitions.h"
 #include "FindSessionsCallbackProxyAdvanced.generated.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(AdvancedFindSessionsLog, Log, All);
+
+class UAdvancedSessionsCacheSubsystem;
+
+// A filter list compiled once for client side filtering, keys are hashed up front and numeric comparands pulled out of their FVariantData
+// Strings are compared in place, no FString is copied per result
+struct ADVANCEDSESSIONS_API FSessionFilterProgram
+{
+public:
+	FSessionFilterProgram(const TArray<FSessionsSearchSetting>& Filters);
+
+	// Whether the settings pass every filter, a key missing from the settings does not filter them out
+	bool Matches(const FSessionSettings& Settings) const;
+
+	// Adds the indices of the passing results to OutIndices, in their original order
+	void Filter(const TArray<FBlueprintSessionResult>& SessionResults, TArray<int32>& OutIndices) const;
+
+private:
+	struct FInstruction
+	{
+		FName Key;
+		uint32 KeyHash;
+		EOnlineKeyValuePairDataType::Type Type;
+		EOnlineComparisonOpRedux Op;
+
+		// Only the comparand matching Type is set, bools compare against the variant itself
+		int32 Int32Value;
+		uint64 Int64Value;
+		double DoubleValue;
+		FString StringValue;
+		FVariantData Data;
+	};
+
+	TArray<FInstruction> Instructions;
+};
+
 UCLASS(MinimalAPI)
 class UFindSessionsCallbackProxyAdvanced : public UOnlineBlueprintCallProxyBase
 {
 	GENERATED_UCLASS_BODY()
 
+	friend class UAdvancedSessionsCacheSubsystem;
+
 	// Called when there is a successful query
 	UPROPERTY(BlueprintAssignable)
 	FBlueprintFindSessionsResultDelegate OnSuccess;
@@ -20,15 +59,28 @@ class UFindSessionsCallbackProxyAdvanced : public UOnlineBlueprintCallProxyBase
 	UPROPERTY(BlueprintAssignable)
 	FBlueprintFindSessionsResultDelegate OnFailure;
 
+	// Called with the new results each time one of the searches of an AllServers query completes, OnSuccess still gets the merged results at the end
+	UPROPERTY(BlueprintAssignable)
+	FBlueprintFindSessionsResultDelegate OnPartialResults;
+
+	// Called with up to ResultsBatchSize results per frame as they come in, OnSuccess follows once the last batch is out
+	UPROPERTY(BlueprintAssignable)
+	FBlueprintFindSessionsResultDelegate OnResultsBatch;
+
 	// Searches for advertised sessions with the default online subsystem and includes an array of filters
+	// A CacheTimeToLive above 0 answers from the session cache, results older than it are still returned but refreshed in the background
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", AutoCreateRefTerm="Filters"), Category = "Online|AdvancedSessions")
-	static UFindSessionsCallbackProxyAdvanced* FindSessionsAdvanced(UObject* WorldContextObject, class APlayerController* PlayerController, int32 MaxResults, bool bUseLAN, EBPServerPresenceSearchType ServerTypeToSearch, const TArray<FSessionsSearchSetting> &Filters, bool bEmptyServersOnly = false, bool bNonEmptyServersOnly = false, bool bSecureServersOnly = false, bool bSearchLobbies = true, int MinSlotsAvailable = 0);
+	static UFindSessionsCallbackProxyAdvanced* FindSessionsAdvanced(UObject* WorldContextObject, class APlayerController* PlayerController, int32 MaxResults, bool bUseLAN, EBPServerPresenceSearchType ServerTypeToSearch, const TArray<FSessionsSearchSetting> &Filters, bool bEmptyServersOnly = false, bool bNonEmptyServersOnly = false, bool bSecureServersOnly = false, bool bSearchLobbies = true, int MinSlotsAvailable = 0, int ResultsBatchSize = 0, float CacheTimeToLive = 0.f);
 
 	static bool CompareVariants(const FVariantData &A, const FVariantData &B, EOnlineComparisonOpRedux Comparator);
 	
 	// Filters an array of session results by the given search parameters, returns a new array with the filtered results
 	UFUNCTION(BluePrintCallable, meta = (Category = "Online|AdvancedSessions"))
 	static void FilterSessionResults(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, TArray<FBlueprintSessionResult> &FilteredResults);
+
+	// Filters an array of session results by the given search parameters, returns the indices of the passing results instead of copies
+	UFUNCTION(BluePrintCallable, meta = (Category = "Online|AdvancedSessions"))
+	static void FilterSessionResultIndices(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, TArray<int32> &FilteredIndices);
 	
 	// Removed, the default built in versions work fine in the normal FindSessionsCallbackProxy
 	/*UFUNCTION(BlueprintPure, Category = "Online|Session")
@@ -48,12 +100,56 @@ class UFindSessionsCallbackProxyAdvanced : public UOnlineBlueprintCallProxyBase
 	virtual void Activate() override;
 	// End of UOnlineBlueprintCallProxyBase interface
 
+	virtual void BeginDestroy() override;
+
 private:
 	// Internal callback when the session search completes, calls out to the public success/failure callbacks
 	void OnCompleted(bool bSuccess);
 
+	// Adds the results of a finished search once, returns false while the search is still running
+	bool CollectSearchResults(const TSharedPtr<FOnlineSessionSearch>& Search, bool& bCollected);
+
+	// Starts handing out results that arrived since the last batch
+	void BatchNewResults();
+
+	// Hands the next ResultsBatchSize results to OnResultsBatch
+	void BroadcastNextResultsBatch();
+
+	// Spreads the remaining batches over the following frames
+	bool TickResultsBatches(float DeltaTime);
+
+	// Calls OnSuccess or OnFailure with everything found
+	void BroadcastCompletion();
+
+	// Stops a search in flight without calling out, used by the cache to free the session interface
+	void CancelSearch();
+
+	// Completes the search with cached results if there are any
+	bool CompleteFromCache();
+
+	// Normalized query, filters in any order and every search parameter
+	FString MakeCacheKey() const;
+
+	UAdvancedSessionsCacheSubsystem* GetSessionsCache() const;
+
+	// Whether the dedicated search runs alongside the presence search
 	bool bRunSecondSearch;
-	bool bIsOnSecondSearch;
+
+	// Whether the subsystem could not take both searches at once, the dedicated one then waits for the presence search
+	bool bSecondSearchDeferred;
+
+	bool bFirstSearchCollected;
+	bool bSecondSearchCollected;
+
+	// Whether every search has finished, OnSuccess or OnFailure may still wait for the last batches
+	bool bSearchCompleted;
+
+	bool bSearchSucceeded;
+
+	// Results already handed to OnResultsBatch
+	int32 NumBatchedResults;
+
+	FTSTicker::FDelegateHandle BatchTickerHandle;
 
 	TArray<FBlueprintSessionResult> SessionSearchResults;
 
@@ -98,6 +194,20 @@ private:
 	// Min slots requires to search
 	int MinSlotsAvailable;
 
+	// Results per OnResultsBatch call, 0 delivers everything through OnSuccess only
+	int ResultsBatchSize;
+
+	// Age in seconds up to which cached results count as fresh, 0 skips the cache
+	float CacheTimeToLive;
+
+	FString CacheKey;
+
+	// Whether the results of this search go into the session cache
+	bool bWriteToCache;
+
+	// Whether the session cache started this search, foreground searches cancel it and it never calls out
+	bool bBackgroundRefresh;
+
 	// The world context object in which this call is taking place
 	UObject* WorldContextObject;
 };
@@ -0,0 +1,46 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+#pragma once
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "FindSessionsCallbackProxy.h"
+#include "BlueprintDataDefinitions.h"
+#include "SortSessionResultsCallbackProxy.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FBlueprintSortSessionsResultDelegate, const TArray<int32>&, SortedIndices);
+
+UCLASS(MinimalAPI)
+class USortSessionResultsCallbackProxy : public UOnlineBlueprintCallProxyBase
+{
+	GENERATED_UCLASS_BODY()
+
+	// Called with the indices of the passing results in sorted order, index into the array that was passed in
+	UPROPERTY(BlueprintAssignable)
+	FBlueprintSortSessionsResultDelegate OnCompleted;
+
+	// Filters and sorts session results on worker threads, large server lists never stall the game thread
+	// Results missing the sort setting, or holding it with another type, go last
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true", WorldContext = "WorldContextObject", AutoCreateRefTerm = "Filters"), Category = "Online|AdvancedSessions")
+	static USortSessionResultsCallbackProxy* FilterAndSortSessionResultsAsync(UObject* WorldContextObject, const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, EBPSessionSortKey SortBy, FName SortSettingName, bool bDescending = false);
+
+	// Synchronous version, filters and sorts with ParallelFor on the calling thread
+	ADVANCEDSESSIONS_API static void FilterAndSortSessionResults(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, EBPSessionSortKey SortBy, FName SortSettingName, bool bDescending, TArray<int32> &SortedIndices);
+
+	// UOnlineBlueprintCallProxyBase interface
+	virtual void Activate() override;
+	// End of UOnlineBlueprintCallProxyBase interface
+
+private:
+	// Copied in, Blueprint is free to change its array while the sort runs
+	TArray<FBlueprintSessionResult> SessionResults;
+
+	TArray<FSessionsSearchSetting> Filters;
+
+	EBPSessionSortKey SortBy;
+
+	FName SortSettingName;
+
+	bool bDescending;
+
+	// The world context object in which this call is taking place
+	UObject* WorldContextObject;
+};
@@ -0,0 +1,114 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+#include "AdvancedSessionsCacheSubsystem.h"
+#include "FindSessionsCallbackProxyAdvanced.h"
+
+//////////////////////////////////////////////////////////////////////////
+// UAdvancedSessionsCacheSubsystem
+
+void UAdvancedSessionsCacheSubsystem::InvalidateSessionsCache()
+{
+	Entries.Empty();
+}
+
+void UAdvancedSessionsCacheSubsystem::Deinitialize()
+{
+	CancelRefreshes();
+	Entries.Empty();
+
+	Super::Deinitialize();
+}
+
+const FAdvancedSessionsCacheEntry* UAdvancedSessionsCacheSubsystem::FindEntry(const FString& Key) const
+{
+	const FAdvancedSessionsCacheEntry* Entry = Entries.Find(Key);
+
+	if (Entry && FPlatformTime::Seconds() - Entry->Time > MaxStaleAge)
+		return nullptr;
+
+	return Entry;
+}
+
+void UAdvancedSessionsCacheSubsystem::StoreResults(const FString& Key, const TArray<FBlueprintSessionResult>& Results)
+{
+	FAdvancedSessionsCacheEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.Results = Results;
+	Entry.Time = FPlatformTime::Seconds();
+}
+
+void UAdvancedSessionsCacheSubsystem::RefreshInBackground(const FString& Key, const UFindSessionsCallbackProxyAdvanced* Request)
+{
+	for (const UFindSessionsCallbackProxyAdvanced* Proxy : RefreshProxies)
+	{
+		if (Proxy->CacheKey == Key)
+			return;
+	}
+
+	// The game instance outlives the world of the request, so the refresh always finds its way back here
+	UFindSessionsCallbackProxyAdvanced* Proxy = UFindSessionsCallbackProxyAdvanced::FindSessionsAdvanced(GetGameInstance(), Request->PlayerControllerWeakPtr.Get(), Request->MaxResults, Request->bUseLAN, Request->ServerSearchType, Request->SearchSettings,
+		Request->bEmptyServersOnly, Request->bNonEmptyServersOnly, Request->bSecureServersOnly, Request->bSearchLobbies, Request->MinSlotsAvailable);
+
+	// Nobody listens to the proxy, its results only land in the cache
+	Proxy->CacheKey = Key;
+	Proxy->bWriteToCache = true;
+
+	Proxy->bBackgroundRefresh = true;
+
+	RefreshProxies.Add(Proxy);
+	RefreshStartTimes.Add(FPlatformTime::Seconds());
+
+	if (!ExpireTickerHandle.IsValid())
+		ExpireTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::ExpireRefreshes), 1.f);
+
+	Proxy->Activate();
+}
+
+void UAdvancedSessionsCacheSubsystem::OnRefreshCompleted(UFindSessionsCallbackProxyAdvanced* Proxy)
+{
+	const int32 Index = RefreshProxies.Find(Proxy);
+
+	if (Index == INDEX_NONE)
+		return;
+
+	RefreshProxies.RemoveAtSwap(Index);
+	RefreshStartTimes.RemoveAtSwap(Index);
+}
+
+void UAdvancedSessionsCacheSubsystem::CancelRefreshes()
+{
+	// Cleared first, cancelling must not call back into OnRefreshCompleted while iterating
+	TArray<UFindSessionsCallbackProxyAdvanced*> Proxies = MoveTemp(RefreshProxies);
+	RefreshProxies.Reset();
+	RefreshStartTimes.Reset();
+
+	for (UFindSessionsCallbackProxyAdvanced* Proxy : Proxies)
+		Proxy->CancelSearch();
+
+	FTSTicker::GetCoreTicker().RemoveTicker(ExpireTickerHandle);
+	ExpireTickerHandle.Reset();
+}
+
+bool UAdvancedSessionsCacheSubsystem::ExpireRefreshes(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	for (int32 i = RefreshProxies.Num() - 1; i >= 0; i--)
+	{
+		if (Now - RefreshStartTimes[i] < RefreshTimeout)
+			continue;
+
+		// A search that hangs this long will not be trusted again, its query goes to the backend next time
+		UFindSessionsCallbackProxyAdvanced* Proxy = RefreshProxies[i];
+		Entries.Remove(Proxy->CacheKey);
+
+		RefreshProxies.RemoveAtSwap(i);
+		RefreshStartTimes.RemoveAtSwap(i);
+
+		Proxy->CancelSearch();
+	}
+
+	if (IsRefreshing())
+		return true;
+
+	ExpireTickerHandle.Reset();
+	return false;
+}
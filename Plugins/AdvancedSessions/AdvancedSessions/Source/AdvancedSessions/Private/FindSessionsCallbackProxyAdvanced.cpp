@@ -1,9 +1,12 @@
 // Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
 #include "FindSessionsCallbackProxyAdvanced.h"
+#include "AdvancedSessionsCacheSubsystem.h"
+#include "Engine/GameInstance.h"
 
 
 //////////////////////////////////////////////////////////////////////////
 // UFindSessionsCallbackProxyAdvanced
+DEFINE_LOG_CATEGORY(AdvancedFindSessionsLog);
 
 
 UFindSessionsCallbackProxyAdvanced::UFindSessionsCallbackProxyAdvanced(const FObjectInitializer& ObjectInitializer)
@@ -12,10 +15,19 @@ UFindSessionsCallbackProxyAdvanced::UFindSessionsCallbackProxyAdvanced(const FOb
 	, bUseLAN(false)
 {
 	bRunSecondSearch = false;
-	bIsOnSecondSearch = false;
+	bSecondSearchDeferred = false;
+	bFirstSearchCollected = false;
+	bSecondSearchCollected = false;
+	bSearchCompleted = false;
+	bSearchSucceeded = false;
+	NumBatchedResults = 0;
+	ResultsBatchSize = 0;
+	CacheTimeToLive = 0.f;
+	bWriteToCache = false;
+	bBackgroundRefresh = false;
 }
 
-UFindSessionsCallbackProxyAdvanced* UFindSessionsCallbackProxyAdvanced::FindSessionsAdvanced(UObject* WorldContextObject, class APlayerController* PlayerController, int MaxResults, bool bUseLAN, EBPServerPresenceSearchType ServerTypeToSearch, const TArray<FSessionsSearchSetting> &Filters, bool bEmptyServersOnly, bool bNonEmptyServersOnly, bool bSecureServersOnly, bool bSearchLobbies, int MinSlotsAvailable)
+UFindSessionsCallbackProxyAdvanced* UFindSessionsCallbackProxyAdvanced::FindSessionsAdvanced(UObject* WorldContextObject, class APlayerController* PlayerController, int MaxResults, bool bUseLAN, EBPServerPresenceSearchType ServerTypeToSearch, const TArray<FSessionsSearchSetting> &Filters, bool bEmptyServersOnly, bool bNonEmptyServersOnly, bool bSecureServersOnly, bool bSearchLobbies, int MinSlotsAvailable, int ResultsBatchSize, float CacheTimeToLive)
 {
 	UFindSessionsCallbackProxyAdvanced* Proxy = NewObject<UFindSessionsCallbackProxyAdvanced>();	
 	Proxy->PlayerControllerWeakPtr = PlayerController;
@@ -29,11 +41,24 @@ UFindSessionsCallbackProxyAdvanced* UFindSessionsCallbackProxyAdvanced::FindSess
 	Proxy->bSecureServersOnly = bSecureServersOnly;
 	Proxy->bSearchLobbies = bSearchLobbies;
 	Proxy->MinSlotsAvailable = MinSlotsAvailable;
+	Proxy->ResultsBatchSize = FMath::Max(ResultsBatchSize, 0);
+	Proxy->CacheTimeToLive = CacheTimeToLive;
 	return Proxy;
 }
 
 void UFindSessionsCallbackProxyAdvanced::Activate()
 {
+	if (CacheTimeToLive > 0.f && CompleteFromCache())
+		return;
+
+	// A search the player waits for never queues behind a refresh, the refresh is cancelled so the subsystem takes this one right away
+	if (!bBackgroundRefresh)
+	{
+		UAdvancedSessionsCacheSubsystem* Cache = GetSessionsCache();
+		if (Cache && Cache->IsRefreshing())
+			Cache->CancelRefreshes();
+	}
+
 	FOnlineSubsystemBPCallHelperAdvanced Helper(TEXT("FindSessions"), GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull));
 	Helper.QueryIDFromPlayerController(PlayerControllerWeakPtr.Get());
 
@@ -44,7 +69,16 @@ void UFindSessionsCallbackProxyAdvanced::Activate()
 		{
 			// Re-initialize here, otherwise I think there might be issues with people re-calling search for some reason before it is destroyed
 			bRunSecondSearch = false;
-			bIsOnSecondSearch = false;
+			bSecondSearchDeferred = false;
+			bFirstSearchCollected = false;
+			bSecondSearchCollected = false;
+			bSearchCompleted = false;
+			bSearchSucceeded = false;
+			NumBatchedResults = 0;
+			SessionSearchResults.Empty();
+
+			FTSTicker::GetCoreTicker().RemoveTicker(BatchTickerHandle);
+			BatchTickerHandle.Reset();
 
 			DelegateHandle = Sessions->AddOnFindSessionsCompleteDelegate_Handle(Delegate);
 
@@ -154,7 +188,29 @@ void UFindSessionsCallbackProxyAdvanced::Activate()
 			// Copy the derived temp variable over to it's base class
 			SearchObject->QuerySettings = tem;
 
-			Sessions->FindSessions(*Helper.UserID, SearchObject.ToSharedRef());
+			// Held back until the first search is issued, a search failing right away then starts the second one itself
+			bSecondSearchDeferred = bRunSecondSearch;
+
+			// Subsystems already running a search ignore or reject this one and leave it untouched, it would never call back
+			if (!Sessions->FindSessions(*Helper.UserID, SearchObject.ToSharedRef()) || SearchObject->SearchState == EOnlineAsyncTaskState::NotStarted)
+			{
+				if (SearchObject->SearchState == EOnlineAsyncTaskState::NotStarted || SearchObject->SearchState == EOnlineAsyncTaskState::InProgress)
+					SearchObject->SearchState = EOnlineAsyncTaskState::Failed;
+			}
+
+			// Issue the dedicated search right away so both backend round trips overlap
+			if (bSecondSearchDeferred)
+			{
+				bSecondSearchDeferred = false;
+				Sessions->FindSessions(*Helper.UserID, SearchObjectDedicated.ToSharedRef());
+
+				// Subsystems that only run one search at a time ignore or reject the second one and leave it untouched
+				bSecondSearchDeferred = SearchObjectDedicated->SearchState == EOnlineAsyncTaskState::NotStarted;
+			}
+
+			// A first search that will not call back is handled here, OnCompleted starts a deferred second search or finishes
+			if (!bSearchCompleted && SearchObject->SearchState != EOnlineAsyncTaskState::InProgress)
+				OnCompleted(false);
 
 			// OnQueryCompleted will get called, nothing more to do now
 			return;
@@ -166,15 +222,60 @@ void UFindSessionsCallbackProxyAdvanced::Activate()
 	}
 
 	// Fail immediately
-	OnFailure.Broadcast(SessionSearchResults);
+	bSearchSucceeded = false;
+	BroadcastCompletion();
 }
 
 void UFindSessionsCallbackProxyAdvanced::OnCompleted(bool bSuccess)
 {
+	// Every search of the session interface calls this, including ones we did not start
+	if (bSearchCompleted)
+		return;
+
 	FOnlineSubsystemBPCallHelperAdvanced Helper(TEXT("FindSessionsCallback"), GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull));
 	Helper.QueryIDFromPlayerController(PlayerControllerWeakPtr.Get());
 
-	if (!bRunSecondSearch && Helper.IsValid())
+	// The delegate does not say which search completed, so each search is tracked by its own state
+	const int32 NumPreviousResults = SessionSearchResults.Num();
+	const bool bFirstSearchDone = CollectSearchResults(SearchObject, bFirstSearchCollected);
+	bool bSecondSearchDone = !bRunSecondSearch || CollectSearchResults(SearchObjectDedicated, bSecondSearchCollected);
+
+	if (bRunSecondSearch && SessionSearchResults.Num() > NumPreviousResults)
+	{
+		TArray<FBlueprintSessionResult> NewResults(SessionSearchResults.GetData() + NumPreviousResults, SessionSearchResults.Num() - NumPreviousResults);
+		OnPartialResults.Broadcast(NewResults);
+	}
+
+	BatchNewResults();
+
+	if (bFirstSearchDone && bSecondSearchDeferred)
+	{
+		bSecondSearchDeferred = false;
+
+		IOnlineSessionPtr Sessions;
+		if (Helper.IsValid())
+			Sessions = Helper.OnlineSub->GetSessionInterface();
+
+		// We lost our player controller, or the subsystem refused or ignored the search
+		if (!Sessions.IsValid() || !Sessions->FindSessions(*Helper.UserID, SearchObjectDedicated.ToSharedRef()) || SearchObjectDedicated->SearchState == EOnlineAsyncTaskState::NotStarted)
+		{
+			if (SearchObjectDedicated->SearchState != EOnlineAsyncTaskState::Done)
+				SearchObjectDedicated->SearchState = EOnlineAsyncTaskState::Failed;
+		}
+
+		// The search may have completed inside FindSessions already
+		if (bSearchCompleted)
+			return;
+
+		bSecondSearchDone = CollectSearchResults(SearchObjectDedicated, bSecondSearchCollected);
+	}
+
+	if (!bFirstSearchDone || !bSecondSearchDone)
+		return;
+
+	bSearchCompleted = true;
+
+	if (Helper.IsValid())
 	{
 		auto Sessions = Helper.OnlineSub->GetSessionInterface();
 		if (Sessions.IsValid())
@@ -183,111 +284,207 @@ void UFindSessionsCallbackProxyAdvanced::OnCompleted(bool bSuccess)
 		}
 	}
 
-	if (bSuccess)
+	// Need to account for only one of the searches failing
+	const bool bAnySearchSucceeded = SearchObject->SearchState == EOnlineAsyncTaskState::Done || (bRunSecondSearch && SearchObjectDedicated->SearchState == EOnlineAsyncTaskState::Done);
+	bSearchSucceeded = bAnySearchSucceeded || SessionSearchResults.Num() > 0;
+
+	// Batches still going out, the ticker completes the search after the last one
+	if (BatchTickerHandle.IsValid())
+		return;
+
+	BroadcastCompletion();
+}
+
+void UFindSessionsCallbackProxyAdvanced::BatchNewResults()
+{
+	// The first batch goes out right away, the rest one per frame
+	if (ResultsBatchSize > 0 && NumBatchedResults < SessionSearchResults.Num() && !BatchTickerHandle.IsValid())
 	{
-		if (bIsOnSecondSearch)
-		{
-			if (SearchObjectDedicated.IsValid())
-			{
-				// Just log the results for now, will need to add a blueprint-compatible search result struct
-				for (auto& Result : SearchObjectDedicated->SearchResults)
-				{
-					FString ResultText = FString::Printf(TEXT("Found a session. Ping is %d"), Result.PingInMs);
+		BroadcastNextResultsBatch();
 
-					FFrame::KismetExecutionMessage(*ResultText, ELogVerbosity::Log);
+		if (NumBatchedResults < SessionSearchResults.Num())
+			BatchTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickResultsBatches));
+	}
+}
 
-					FBlueprintSessionResult BPResult;
-					BPResult.OnlineResult = Result;
-					SessionSearchResults.Add(BPResult);
-				}
-				OnSuccess.Broadcast(SessionSearchResults);
-				return;
-			}
-		}
-		else
-		{
-			if (SearchObject.IsValid())
-			{
-				// Just log the results for now, will need to add a blueprint-compatible search result struct
-				for (auto& Result : SearchObject->SearchResults)
-				{
-					FString ResultText = FString::Printf(TEXT("Found a session. Ping is %d"), Result.PingInMs);
+void UFindSessionsCallbackProxyAdvanced::BroadcastNextResultsBatch()
+{
+	const int32 NumResults = FMath::Min(ResultsBatchSize, SessionSearchResults.Num() - NumBatchedResults);
 
-					FFrame::KismetExecutionMessage(*ResultText, ELogVerbosity::Log);
+	TArray<FBlueprintSessionResult> Batch(SessionSearchResults.GetData() + NumBatchedResults, NumResults);
+	NumBatchedResults += NumResults;
 
-					FBlueprintSessionResult BPResult;
-					BPResult.OnlineResult = Result;
-					SessionSearchResults.Add(BPResult);
-				}
-				if (!bRunSecondSearch)
-				{
-					OnSuccess.Broadcast(SessionSearchResults);
-					return;
-				}
-			}
+	OnResultsBatch.Broadcast(Batch);
+}
+
+bool UFindSessionsCallbackProxyAdvanced::TickResultsBatches(float DeltaTime)
+{
+	BroadcastNextResultsBatch();
+
+	if (NumBatchedResults < SessionSearchResults.Num())
+		return true;
+
+	BatchTickerHandle.Reset();
+
+	if (bSearchCompleted)
+		BroadcastCompletion();
+
+	return false;
+}
+
+void UFindSessionsCallbackProxyAdvanced::BroadcastCompletion()
+{
+	if (bWriteToCache)
+	{
+		if (UAdvancedSessionsCacheSubsystem* Cache = GetSessionsCache())
+		{
+			// A failed search keeps the previous results around
+			if (bSearchSucceeded)
+				Cache->StoreResults(CacheKey, SessionSearchResults);
+
+			Cache->OnRefreshCompleted(this);
 		}
 	}
+
+	// Nobody listens to a background refresh
+	if (bBackgroundRefresh)
+		return;
+
+	if (bSearchSucceeded)
+		OnSuccess.Broadcast(SessionSearchResults);
 	else
+		OnFailure.Broadcast(SessionSearchResults);
+}
+
+void UFindSessionsCallbackProxyAdvanced::CancelSearch()
+{
+	if (bSearchCompleted)
+		return;
+
+	bSearchCompleted = true;
+	bSearchSucceeded = false;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(BatchTickerHandle);
+	BatchTickerHandle.Reset();
+
+	FOnlineSubsystemBPCallHelperAdvanced Helper(TEXT("CancelFindSessions"), GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull));
+	Helper.QueryIDFromPlayerController(PlayerControllerWeakPtr.Get());
+
+	if (Helper.IsValid())
 	{
-		if (!bRunSecondSearch)
+		auto Sessions = Helper.OnlineSub->GetSessionInterface();
+		if (Sessions.IsValid())
 		{
-			// Need to account for only one of the searches failing
-			if (SessionSearchResults.Num() > 0)
-				OnSuccess.Broadcast(SessionSearchResults);
-			else
-				OnFailure.Broadcast(SessionSearchResults);
-			return;
+			Sessions->ClearOnFindSessionsCompleteDelegate_Handle(DelegateHandle);
+			Sessions->CancelFindSessions();
 		}
 	}
+}
+
+bool UFindSessionsCallbackProxyAdvanced::CompleteFromCache()
+{
+	UAdvancedSessionsCacheSubsystem* Cache = GetSessionsCache();
+
+	if (!Cache)
+		return false;
+
+	CacheKey = MakeCacheKey();
+	const FAdvancedSessionsCacheEntry* Entry = Cache->FindEntry(CacheKey);
 
-	if (Helper.IsValid() && bRunSecondSearch && ServerSearchType == EBPServerPresenceSearchType::AllServers)
+	if (!Entry)
 	{
-		bRunSecondSearch = false;
-		bIsOnSecondSearch = true;
-		auto Sessions = Helper.OnlineSub->GetSessionInterface();
-		Sessions->FindSessions(*Helper.UserID, SearchObjectDedicated.ToSharedRef());
+		bWriteToCache = true;
+		return false;
 	}
-	else // We lost our player controller
+
+	bWriteToCache = false;
+
+	if (FPlatformTime::Seconds() - Entry->Time > CacheTimeToLive)
+		Cache->RefreshInBackground(CacheKey, this);
+
+	FTSTicker::GetCoreTicker().RemoveTicker(BatchTickerHandle);
+	BatchTickerHandle.Reset();
+	NumBatchedResults = 0;
+
+	SessionSearchResults = Entry->Results;
+	bSearchCompleted = true;
+	bSearchSucceeded = true;
+
+	BatchNewResults();
+
+	if (!BatchTickerHandle.IsValid())
+		BroadcastCompletion();
+
+	return true;
+}
+
+FString UFindSessionsCallbackProxyAdvanced::MakeCacheKey() const
+{
+	// Sorted so the same filters added in another order share the entry
+	TArray<FString> Filters;
+	for (const FSessionsSearchSetting& Setting : SearchSettings)
 	{
-		if (bSuccess && SessionSearchResults.Num() > 0)
-			OnSuccess.Broadcast(SessionSearchResults);
-		else
-			OnFailure.Broadcast(SessionSearchResults);
+		Filters.Add(FString::Printf(TEXT("%s:%s:%d:%s"), *Setting.PropertyKeyPair.Key.ToString(), EOnlineKeyValuePairDataType::ToString(Setting.PropertyKeyPair.Data.GetType()),
+			(int32)Setting.ComparisonOp, *Setting.PropertyKeyPair.Data.ToString()));
 	}
+	Filters.Sort();
+
+	return FString::Printf(TEXT("%d|%d|%d|%d|%d|%d|%d|%d|%s"), MaxResults, (int32)bUseLAN, (int32)ServerSearchType, (int32)bEmptyServersOnly, (int32)bNonEmptyServersOnly,
+		(int32)bSecureServersOnly, (int32)bSearchLobbies, MinSlotsAvailable, *FString::Join(Filters, TEXT(";")));
 }
 
+UAdvancedSessionsCacheSubsystem* UFindSessionsCallbackProxyAdvanced::GetSessionsCache() const
+{
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	return World ? UGameInstance::GetSubsystem<UAdvancedSessionsCacheSubsystem>(World->GetGameInstance()) : nullptr;
+}
 
-void UFindSessionsCallbackProxyAdvanced::FilterSessionResults(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, TArray<FBlueprintSessionResult> &FilteredResults)
+void UFindSessionsCallbackProxyAdvanced::BeginDestroy()
 {
-	for (int j = 0; j < SessionResults.Num(); j++)
-	{
-		bool bAddResult = true;
+	FTSTicker::GetCoreTicker().RemoveTicker(BatchTickerHandle);
+	BatchTickerHandle.Reset();
 
-		// Filter results
-		if (Filters.Num() > 0)
-		{
-			const FOnlineSessionSetting * setting;
-			for (int i = 0; i < Filters.Num(); i++)
-			{
-				setting = SessionResults[j].OnlineResult.Session.SessionSettings.Settings.Find(Filters[i].PropertyKeyPair.Key);
+	Super::BeginDestroy();
+}
 
-				// Couldn't find this key
-				if (!setting)
-					continue;
+bool UFindSessionsCallbackProxyAdvanced::CollectSearchResults(const TSharedPtr<FOnlineSessionSearch>& Search, bool& bCollected)
+{
+	if (!Search.IsValid())
+		return true;
 
-				if (!CompareVariants(setting->Data, Filters[i].PropertyKeyPair.Data, Filters[i].ComparisonOp))
-				{
-					bAddResult = false;
-					break;
-				}
-			}
-		}
+	if (Search->SearchState != EOnlineAsyncTaskState::Done && Search->SearchState != EOnlineAsyncTaskState::Failed)
+		return false;
+
+	if (!bCollected && Search->SearchState == EOnlineAsyncTaskState::Done)
+	{
+		for (auto& Result : Search->SearchResults)
+		{
+			// Verbose only, formatting a line per result stalls large server lists
+			UE_LOG(AdvancedFindSessionsLog, Verbose, TEXT("Found a session. Ping is %d"), Result.PingInMs);
 
-		if (bAddResult)
-			FilteredResults.Add(SessionResults[j]);
+			FBlueprintSessionResult BPResult;
+			BPResult.OnlineResult = Result;
+			SessionSearchResults.Add(BPResult);
+		}
 	}
 
-	return;
+	bCollected = true;
+	return true;
+}
+
+void UFindSessionsCallbackProxyAdvanced::FilterSessionResults(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, TArray<FBlueprintSessionResult> &FilteredResults)
+{
+	TArray<int32> FilteredIndices;
+	FSessionFilterProgram(Filters).Filter(SessionResults, FilteredIndices);
+
+	FilteredResults.Reserve(FilteredResults.Num() + FilteredIndices.Num());
+	for (int32 Index : FilteredIndices)
+		FilteredResults.Add(SessionResults[Index]);
+}
+
+void UFindSessionsCallbackProxyAdvanced::FilterSessionResultIndices(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, TArray<int32> &FilteredIndices)
+{
+	FSessionFilterProgram(Filters).Filter(SessionResults, FilteredIndices);
 }
 
 
@@ -433,4 +630,176 @@ bool UFindSessionsCallbackProxyAdvanced::CompareVariants(const FVariantData &A,
 
 
 
-}
\ No newline at end of file
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// FSessionFilterProgram
+
+template<typename ValueType>
+static bool CompareFilterValues(ValueType A, ValueType B, EOnlineComparisonOpRedux Comparator)
+{
+	switch (Comparator)
+	{
+	case EOnlineComparisonOpRedux::Equals:
+		return A == B;
+	case EOnlineComparisonOpRedux::NotEquals:
+		return A != B;
+	case EOnlineComparisonOpRedux::GreaterThanEquals:
+		return A >= B;
+	case EOnlineComparisonOpRedux::LessThanEquals:
+		return A <= B;
+	case EOnlineComparisonOpRedux::GreaterThan:
+		return A > B;
+	case EOnlineComparisonOpRedux::LessThan:
+		return A < B;
+	default:
+		return false;
+	}
+}
+
+FSessionFilterProgram::FSessionFilterProgram(const TArray<FSessionsSearchSetting>& Filters)
+{
+	Instructions.Reserve(Filters.Num());
+
+	for (const FSessionsSearchSetting& Filter : Filters)
+	{
+		FInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+		Instruction.Key = Filter.PropertyKeyPair.Key;
+		Instruction.KeyHash = GetTypeHash(Instruction.Key);
+		Instruction.Type = Filter.PropertyKeyPair.Data.GetType();
+		Instruction.Op = Filter.ComparisonOp;
+		Instruction.Int32Value = 0;
+		Instruction.Int64Value = 0;
+		Instruction.DoubleValue = 0.0;
+
+		switch (Instruction.Type)
+		{
+		case EOnlineKeyValuePairDataType::Int32:
+			Filter.PropertyKeyPair.Data.GetValue(Instruction.Int32Value);
+			break;
+
+		case EOnlineKeyValuePairDataType::Int64:
+			Filter.PropertyKeyPair.Data.GetValue(Instruction.Int64Value);
+			break;
+
+		case EOnlineKeyValuePairDataType::Double:
+			Filter.PropertyKeyPair.Data.GetValue(Instruction.DoubleValue);
+			break;
+
+		case EOnlineKeyValuePairDataType::Float:
+		{
+			float Value;
+			Filter.PropertyKeyPair.Data.GetValue(Value);
+			Instruction.DoubleValue = Value;
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::String:
+			Filter.PropertyKeyPair.Data.GetValue(Instruction.StringValue);
+			break;
+
+		default:
+			Instruction.Data = Filter.PropertyKeyPair.Data;
+			break;
+		}
+	}
+}
+
+bool FSessionFilterProgram::Matches(const FSessionSettings& Settings) const
+{
+	for (const FInstruction& Instruction : Instructions)
+	{
+		const FOnlineSessionSetting* Setting = Settings.FindByHash(Instruction.KeyHash, Instruction.Key);
+
+		// Couldn't find this key
+		if (!Setting)
+			continue;
+
+		const FVariantData& Data = Setting->Data;
+
+		if (Data.GetType() != Instruction.Type)
+			return false;
+
+		bool bPassed = false;
+
+		switch (Instruction.Type)
+		{
+		case EOnlineKeyValuePairDataType::Bool:
+		{
+			// Only equality is defined
+			if (Instruction.Op == EOnlineComparisonOpRedux::Equals)
+				bPassed = Data == Instruction.Data;
+			else if (Instruction.Op == EOnlineComparisonOpRedux::NotEquals)
+				bPassed = Data != Instruction.Data;
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::String:
+		{
+			// Only equality is defined, case insensitive like the FString compare this replaced
+			FString Value;
+			Data.GetValue(Value);
+
+			if (Instruction.Op == EOnlineComparisonOpRedux::Equals)
+				bPassed = Value.Equals(Instruction.StringValue, ESearchCase::IgnoreCase);
+			else if (Instruction.Op == EOnlineComparisonOpRedux::NotEquals)
+				bPassed = !Value.Equals(Instruction.StringValue, ESearchCase::IgnoreCase);
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::Int32:
+		{
+			int32 Value;
+			Data.GetValue(Value);
+			bPassed = CompareFilterValues(Value, Instruction.Int32Value, Instruction.Op);
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::Int64:
+		{
+			uint64 Value;
+			Data.GetValue(Value);
+			bPassed = CompareFilterValues(Value, Instruction.Int64Value, Instruction.Op);
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::Double:
+		{
+			double Value;
+			Data.GetValue(Value);
+			bPassed = CompareFilterValues(Value, Instruction.DoubleValue, Instruction.Op);
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::Float:
+		{
+			float Value;
+			Data.GetValue(Value);
+			bPassed = CompareFilterValues((double)Value, Instruction.DoubleValue, Instruction.Op);
+		}
+		break;
+
+		case EOnlineKeyValuePairDataType::Empty:
+		case EOnlineKeyValuePairDataType::Blob:
+		default:
+			break;
+		}
+
+		if (!bPassed)
+			return false;
+	}
+
+	return true;
+}
+
+void FSessionFilterProgram::Filter(const TArray<FBlueprintSessionResult>& SessionResults, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reserve(OutIndices.Num() + SessionResults.Num());
+
+	for (int32 i = 0; i < SessionResults.Num(); i++)
+	{
+		if (Matches(SessionResults[i].OnlineResult.Session.SessionSettings.Settings))
+			OutIndices.Add(i);
+	}
+}
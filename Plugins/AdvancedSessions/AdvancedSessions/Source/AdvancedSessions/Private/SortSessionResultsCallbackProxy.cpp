@@ -0,0 +1,202 @@
+// Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
+#include "SortSessionResultsCallbackProxy.h"
+#include "FindSessionsCallbackProxyAdvanced.h"
+#include "Algo/Sort.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Tasks/Task.h"
+
+namespace SortSessionResults
+{
+	// Results per ParallelFor work item, small lists run on a single worker
+	const int32 ChunkSize = 256;
+
+	struct FEntry
+	{
+		double Key;
+		int32 Index;
+		bool bHasKey;
+	};
+
+	// Missing keys go last in either direction, equal keys keep the order of the results
+	static bool IsBefore(const FEntry& A, const FEntry& B, bool bDescending)
+	{
+		if (A.bHasKey != B.bHasKey)
+			return A.bHasKey;
+
+		if (A.Key != B.Key)
+			return bDescending ? A.Key > B.Key : A.Key < B.Key;
+
+		return A.Index < B.Index;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// USortSessionResultsCallbackProxy
+
+USortSessionResultsCallbackProxy::USortSessionResultsCallbackProxy(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+	, SortBy(EBPSessionSortKey::None)
+	, bDescending(false)
+	, WorldContextObject(nullptr)
+{
+}
+
+USortSessionResultsCallbackProxy* USortSessionResultsCallbackProxy::FilterAndSortSessionResultsAsync(UObject* WorldContextObject, const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, EBPSessionSortKey SortBy, FName SortSettingName, bool bDescending)
+{
+	USortSessionResultsCallbackProxy* Proxy = NewObject<USortSessionResultsCallbackProxy>();
+	Proxy->WorldContextObject = WorldContextObject;
+	Proxy->SessionResults = SessionResults;
+	Proxy->Filters = Filters;
+	Proxy->SortBy = SortBy;
+	Proxy->SortSettingName = SortSettingName;
+	Proxy->bDescending = bDescending;
+	return Proxy;
+}
+
+void USortSessionResultsCallbackProxy::Activate()
+{
+	// Kept alive by the game instance until the indices are back
+	RegisterWithGameInstance(WorldContextObject);
+
+	TWeakObjectPtr<USortSessionResultsCallbackProxy> WeakThis(this);
+
+	// The task owns its inputs, the proxy may be gone by the time it finishes
+	UE::Tasks::Launch(TEXT("FilterAndSortSessionResults"), [WeakThis, Results = MoveTemp(SessionResults), Filters = MoveTemp(Filters), SortBy = SortBy, SortSettingName = SortSettingName, bDescending = bDescending]()
+	{
+		TArray<int32> SortedIndices;
+		FilterAndSortSessionResults(Results, Filters, SortBy, SortSettingName, bDescending, SortedIndices);
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SortedIndices = MoveTemp(SortedIndices)]()
+		{
+			if (USortSessionResultsCallbackProxy* Proxy = WeakThis.Get())
+			{
+				Proxy->OnCompleted.Broadcast(SortedIndices);
+				Proxy->SetReadyToDestroy();
+			}
+		});
+	});
+}
+
+void USortSessionResultsCallbackProxy::FilterAndSortSessionResults(const TArray<FBlueprintSessionResult> &SessionResults, const TArray<FSessionsSearchSetting> &Filters, EBPSessionSortKey SortBy, FName SortSettingName, bool bDescending, TArray<int32> &SortedIndices)
+{
+	using namespace SortSessionResults;
+
+	const FSessionFilterProgram Program(Filters);
+	const uint32 SortSettingHash = GetTypeHash(SortSettingName);
+
+	// Filter and read the sort keys, every chunk collects its passing results in order
+	const int32 NumInputChunks = FMath::DivideAndRoundUp(SessionResults.Num(), ChunkSize);
+	TArray<TArray<FEntry>> ChunkEntries;
+	ChunkEntries.SetNum(NumInputChunks);
+
+	ParallelFor(NumInputChunks, [&](int32 ChunkIndex)
+	{
+		TArray<FEntry>& Entries = ChunkEntries[ChunkIndex];
+		const int32 End = FMath::Min((ChunkIndex + 1) * ChunkSize, SessionResults.Num());
+
+		for (int32 i = ChunkIndex * ChunkSize; i < End; i++)
+		{
+			const FOnlineSessionSearchResult& Result = SessionResults[i].OnlineResult;
+
+			if (!Program.Matches(Result.Session.SessionSettings.Settings))
+				continue;
+
+			FEntry& Entry = Entries.AddDefaulted_GetRef();
+			Entry.Key = 0.0;
+			Entry.Index = i;
+			Entry.bHasKey = true;
+
+			switch (SortBy)
+			{
+			case EBPSessionSortKey::Ping:
+				Entry.Key = Result.PingInMs;
+				break;
+
+			case EBPSessionSortKey::PlayerCount:
+				Entry.Key = Result.Session.SessionSettings.NumPublicConnections - Result.Session.NumOpenPublicConnections;
+				break;
+
+			case EBPSessionSortKey::ExtraSettingInt:
+			case EBPSessionSortKey::ExtraSettingFloat:
+			{
+				const FOnlineSessionSetting* Setting = Result.Session.SessionSettings.Settings.FindByHash(SortSettingHash, SortSettingName);
+				const EOnlineKeyValuePairDataType::Type Type = SortBy == EBPSessionSortKey::ExtraSettingInt ? EOnlineKeyValuePairDataType::Int32 : EOnlineKeyValuePairDataType::Float;
+
+				Entry.bHasKey = Setting && Setting->Data.GetType() == Type;
+
+				if (Entry.bHasKey && Type == EOnlineKeyValuePairDataType::Int32)
+				{
+					int32 Value;
+					Setting->Data.GetValue(Value);
+					Entry.Key = Value;
+				}
+				else if (Entry.bHasKey)
+				{
+					float Value;
+					Setting->Data.GetValue(Value);
+					Entry.Key = Value;
+
+					// NaN compares false both ways, it would break the ordering of the sort and the merges
+					Entry.bHasKey = !FMath::IsNaN(Value);
+				}
+			}
+			break;
+
+			case EBPSessionSortKey::None:
+			default:
+				break;
+			}
+		}
+	});
+
+	TArray<FEntry> Entries;
+	for (TArray<FEntry>& Chunk : ChunkEntries)
+		Entries.Append(Chunk);
+
+	if (SortBy != EBPSessionSortKey::None && Entries.Num() > 1)
+	{
+		const int32 NumEntries = Entries.Num();
+
+		// Sort runs of ChunkSize entries in parallel, then merge neighbouring runs pass by pass
+		ParallelFor(FMath::DivideAndRoundUp(NumEntries, ChunkSize), [&](int32 RunIndex)
+		{
+			const int32 Start = RunIndex * ChunkSize;
+			const int32 Num = FMath::Min(ChunkSize, NumEntries - Start);
+
+			Algo::Sort(TArrayView<FEntry>(Entries.GetData() + Start, Num), [bDescending](const FEntry& A, const FEntry& B) { return IsBefore(A, B, bDescending); });
+		});
+
+		TArray<FEntry> Merged;
+		Merged.SetNumUninitialized(NumEntries);
+
+		for (int32 RunSize = ChunkSize; RunSize < NumEntries; RunSize *= 2)
+		{
+			ParallelFor(FMath::DivideAndRoundUp(NumEntries, RunSize * 2), [&](int32 MergeIndex)
+			{
+				const int32 Start = MergeIndex * RunSize * 2;
+				const int32 Middle = FMath::Min(Start + RunSize, NumEntries);
+				const int32 End = FMath::Min(Start + RunSize * 2, NumEntries);
+
+				int32 A = Start;
+				int32 B = Middle;
+				int32 Out = Start;
+
+				while (A < Middle && B < End)
+					Merged[Out++] = IsBefore(Entries[B], Entries[A], bDescending) ? Entries[B++] : Entries[A++];
+
+				while (A < Middle)
+					Merged[Out++] = Entries[A++];
+
+				while (B < End)
+					Merged[Out++] = Entries[B++];
+			});
+
+			Swap(Entries, Merged);
+		}
+	}
+
+	SortedIndices.Reset(Entries.Num());
+	for (const FEntry& Entry : Entries)
+		SortedIndices.Add(Entry.Index);
+}
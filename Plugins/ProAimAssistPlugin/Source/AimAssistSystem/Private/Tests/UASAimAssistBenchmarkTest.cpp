@@ -0,0 +1,41 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "UASAimAssistBenchmarkCommandlet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUASAimAssistBenchmarkTest, "AimAssist.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FUASAimAssistBenchmarkTest::RunTest(const FString& Parameters)
+{
+	// Same scenarios as the commandlet defaults with fewer frames, so the run fits a CI step.
+	const TArray<int32> numTargets = {10, 100, 1000};
+	const auto numSockets = 3;
+	const auto numFrames = 120;
+
+	TArray<UUASAimAssistBenchmarkCommandlet::FStageResult> results;
+	UUASAimAssistBenchmarkCommandlet::RunScenarios(numTargets, numSockets, numFrames, results);
+
+	if (!TestTrue(TEXT("Every scenario produced stage timings"), results.Num() > 0 && results.Num() % numTargets.Num() == 0))
+	{
+		return false;
+	}
+
+	for (const auto& result : results)
+	{
+		TestTrue(FString::Printf(TEXT("%d targets %s timings are valid"), result.NumTargets, *result.Stage),
+		         FMath::IsFinite(result.Mean) && result.Mean >= 0.0 && result.P50 <= result.P99 && result.P99 <= result.Max);
+
+		AddInfo(FString::Printf(TEXT("%5d targets x %d sockets %-20s mean %8.2fus p50 %8.2fus p90 %8.2fus p99 %8.2fus max %8.2fus"),
+		                        result.NumTargets, result.NumSockets, *result.Stage, result.Mean, result.P50, result.P90, result.P99, result.Max));
+	}
+
+	const auto outputPath = FPaths::AutomationDir() / TEXT("AimAssistBenchmark") / TEXT("AimAssistBenchmark");
+	TestTrue(TEXT("Benchmark report was written"), UUASAimAssistBenchmarkCommandlet::WriteReports(outputPath, results));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,272 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistBenchmarkCommandlet.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshSocket.h"
+#include "Engine/World.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UASAimAssistComponent.h"
+#include "UASAimAssistConfigDataAsset.h"
+#include "UASAimAssistStageTimings.h"
+#include "UASAimAssistTargetComponent.h"
+#include "UASAimAssistTargetSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimAssistBenchmark, Log, All);
+
+UUASAimAssistBenchmarkCommandlet::UUASAimAssistBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UUASAimAssistBenchmarkCommandlet::Main(const FString& Params)
+{
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogAimAssistBenchmark, Error, TEXT("Stage timings are compiled out of shipping builds."));
+	return 1;
+#else
+	FString targetCounts = TEXT("10,100,1000");
+	int32 numSockets = 3;
+	int32 numFrames = 600;
+	FString outputPath = FPaths::ProjectSavedDir() / TEXT("AimAssistBenchmark") / TEXT("AimAssistBenchmark");
+
+	FParse::Value(*Params, TEXT("Targets="), targetCounts);
+	FParse::Value(*Params, TEXT("Sockets="), numSockets);
+	FParse::Value(*Params, TEXT("Frames="), numFrames);
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	TArray<FString> counts;
+	targetCounts.ParseIntoArray(counts, TEXT(","));
+
+	TArray<int32> numTargets;
+
+	for (const auto& count : counts)
+	{
+		numTargets.Add(FCString::Atoi(*count));
+	}
+
+	TArray<FStageResult> results;
+	RunScenarios(numTargets, numSockets, numFrames, results);
+
+	for (const auto& result : results)
+	{
+		UE_LOG(LogAimAssistBenchmark, Display, TEXT("%5d targets x %d sockets %-20s mean %8.2fus p50 %8.2fus p90 %8.2fus p99 %8.2fus max %8.2fus"),
+		       result.NumTargets, result.NumSockets, *result.Stage, result.Mean, result.P50, result.P90, result.P99, result.Max);
+	}
+
+	return WriteReports(outputPath, results) ? 0 : 1;
+#endif
+}
+
+void UUASAimAssistBenchmarkCommandlet::RunScenarios(const TArray<int32>& NumTargets, int32 NumSockets, int32 NumFrames, TArray<FStageResult>& OutResults)
+{
+#if !UE_BUILD_SHIPPING
+	FUASAimAssistStageTimings::bEnabled = true;
+
+	for (const auto numTargets : NumTargets)
+	{
+		if (numTargets > 0)
+		{
+			RunScenario(numTargets, FMath::Max(NumSockets, 1), FMath::Max(NumFrames, 1), OutResults);
+		}
+	}
+
+	FUASAimAssistStageTimings::bEnabled = false;
+#endif
+}
+
+void UUASAimAssistBenchmarkCommandlet::RunScenario(int32 NumTargets, int32 NumSockets, int32 NumFrames, TArray<FStageResult>& OutResults)
+{
+#if !UE_BUILD_SHIPPING
+	auto world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("AimAssistBenchmark"));
+	auto& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	world->InitializeActorsForPlay(FURL());
+	world->GetWorldSettings()->NotifyBeginPlay();
+
+	auto subsystem = world->GetSubsystem<UUASAimAssistTargetSubsystem>();
+
+	// Targets need real bounds and collision to be culled and to block each other, sockets are spread from the feet to the head.
+	// The sockets go on a transient copy, the engine cube itself is never touched.
+	const auto cubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	auto staticMesh = cubeMesh != nullptr ? DuplicateObject<UStaticMesh>(cubeMesh, GetTransientPackage()) : nullptr;
+
+	if (staticMesh == nullptr)
+	{
+		UE_LOG(LogAimAssistBenchmark, Warning, TEXT("Engine cube mesh is missing, targets have no bounds or collision and every socket sits at the target origin."));
+	}
+#if WITH_EDITOR
+	else
+	{
+		// Render data and the cooked collision are not duplicated, build them for the copy.
+		staticMesh->Build(true);
+	}
+#endif
+
+	for (int32 socket = 0; staticMesh != nullptr && socket < NumSockets; ++socket)
+	{
+		auto meshSocket = NewObject<UStaticMeshSocket>(staticMesh);
+		meshSocket->SocketName = FName(TEXT("Socket"), socket + 1);
+		meshSocket->RelativeLocation = FVector(0.f, 0.f, FMath::Lerp(-45.f, 45.f, (socket + 0.5f) / NumSockets));
+		staticMesh->Sockets.Add(meshSocket);
+	}
+
+	FRandomStream random(NumTargets);
+
+	for (int32 i = 0; i < NumTargets; ++i)
+	{
+		const auto location = FRotator(0.f, random.FRandRange(0.f, 360.f), 0.f).Vector() * random.FRandRange(300.f, 6000.f) + FVector(0.f, 0.f, random.FRandRange(-200.f, 200.f));
+
+		auto actor = world->SpawnActor<AActor>();
+		auto mesh = NewObject<UStaticMeshComponent>(actor);
+		actor->SetRootComponent(mesh);
+		mesh->SetStaticMesh(staticMesh);
+		mesh->SetWorldLocationAndRotation(location, FRotator(0.f, random.FRandRange(0.f, 360.f), 0.f));
+		mesh->SetWorldScale3D(FVector(0.6f, 0.6f, 1.8f));
+		mesh->RegisterComponent();
+
+		auto target = NewObject<UUASAimAssistTargetComponent>(actor);
+
+		for (int32 socket = 0; socket < NumSockets; ++socket)
+		{
+			target->AimTargetSocketNames.Add(FName(TEXT("Socket"), socket + 1));
+		}
+
+		target->RegisterComponent();
+		target->Init(mesh);
+	}
+
+	auto config = NewObject<UUASAimAssistConfigDataAsset>();
+	auto controller = world->SpawnActor<APlayerController>();
+	auto pawn = world->SpawnActor<ADefaultPawn>();
+	controller->Possess(pawn);
+
+	auto aimAssist = NewObject<UUASAimAssistComponent>(controller);
+	aimAssist->AimAssistDataAsset = config;
+	aimAssist->RegisterComponent();
+
+	// There is no local player in a commandlet, wire the view up by hand.
+	aimAssist->PlayerController = controller;
+	aimAssist->SetAimAssistDataAsset(config);
+	subsystem->RegisterView(aimAssist);
+
+	// Nothing ticks the async trace queue here, obstacle checks have to complete inside the frame.
+	aimAssist->AimAssistDataAsset->bAsyncObstacleChecks = false;
+
+	TArray<double> samples[static_cast<int32>(EUASAimAssistStage::Num)];
+	const FIntRect viewRect(0, 0, 1920, 1080);
+	const auto projectionMatrix = FReversedZPerspectiveMatrix(FMath::DegreesToRadians(45.f), viewRect.Width(), viewRect.Height(), GNearClippingPlane);
+	const auto deltaTime = 1.f / 60.f;
+
+	for (int32 frame = 0; frame < NumFrames; ++frame)
+	{
+		++GFrameCounter;
+		world->TimeSeconds += deltaTime;
+
+		// One full turn over the run with a slow vertical sway, every frame requests a refresh to measure the worst case.
+		const auto alpha = static_cast<float>(frame) / NumFrames;
+		pawn->SetActorLocation(FVector(0.f, 0.f, 100.f * FMath::Sin(alpha * 4.f * PI)));
+		controller->SetControlRotation(FRotator(5.f * FMath::Sin(alpha * 8.f * PI), 360.f * alpha, 0.f));
+
+		FVector viewLocation;
+		FRotator viewRotation;
+		controller->GetPlayerViewPoint(viewLocation, viewRotation);
+
+		const auto viewRotationMatrix = FInverseRotationMatrix(viewRotation) * FMatrix(FPlane(0, 0, 1, 0), FPlane(1, 0, 0, 0), FPlane(0, 1, 0, 0), FPlane(0, 0, 0, 1));
+		aimAssist->ViewProjectionMatrix = FTranslationMatrix(-viewLocation) * viewRotationMatrix * projectionMatrix;
+		aimAssist->ViewRect = viewRect;
+		aimAssist->ProjectionScale = FMath::Max(projectionMatrix.M[0][0] * viewRect.Width(), projectionMatrix.M[1][1] * viewRect.Height()) * 0.5f;
+		aimAssist->bViewProjectionValid = true;
+		aimAssist->ViewProjectionFrameNumber = GFrameCounter;
+		aimAssist->RefreshViewState();
+
+		FUASAimAssistStageTimings::Reset();
+
+		aimAssist->UpdateAssist();
+		subsystem->Tick(deltaTime);
+		aimAssist->TickComponent(deltaTime, LEVELTICK_All, &aimAssist->PrimaryComponentTick);
+
+		for (int32 stage = 0; stage < static_cast<int32>(EUASAimAssistStage::Num); ++stage)
+		{
+			samples[stage].Add(FUASAimAssistStageTimings::Seconds[stage] * 1000000.0);
+		}
+	}
+
+	for (int32 stage = 0; stage < static_cast<int32>(EUASAimAssistStage::Num); ++stage)
+	{
+		AddStageResult(NumTargets, NumSockets, FUASAimAssistStageTimings::GetStageName(static_cast<EUASAimAssistStage>(stage)), samples[stage], OutResults);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+#endif
+}
+
+void UUASAimAssistBenchmarkCommandlet::AddStageResult(int32 NumTargets, int32 NumSockets, const TCHAR* Stage, TArray<double>& Samples, TArray<FStageResult>& OutResults)
+{
+	if (Samples.Num() == 0)
+	{
+		return;
+	}
+
+	Samples.Sort();
+
+	const auto percentile = [&Samples](double Percent) {
+		return Samples[FMath::Clamp(FMath::CeilToInt(Percent * Samples.Num()) - 1, 0, Samples.Num() - 1)];
+	};
+
+	double total = 0.0;
+
+	for (const auto sample : Samples)
+	{
+		total += sample;
+	}
+
+	auto& result = OutResults.AddDefaulted_GetRef();
+	result.NumTargets = NumTargets;
+	result.NumSockets = NumSockets;
+	result.Stage = Stage;
+	result.Mean = total / Samples.Num();
+	result.P50 = percentile(0.5);
+	result.P90 = percentile(0.9);
+	result.P99 = percentile(0.99);
+	result.Max = Samples.Last();
+}
+
+bool UUASAimAssistBenchmarkCommandlet::WriteReports(const FString& OutputPath, const TArray<FStageResult>& Results)
+{
+	FString csv = TEXT("Targets,Sockets,Stage,MeanUs,P50Us,P90Us,P99Us,MaxUs\n");
+	FString json = TEXT("[\n");
+
+	for (int32 i = 0; i < Results.Num(); ++i)
+	{
+		const auto& result = Results[i];
+
+		csv += FString::Printf(TEXT("%d,%d,%s,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+		                       result.NumTargets, result.NumSockets, *result.Stage, result.Mean, result.P50, result.P90, result.P99, result.Max);
+
+		json += FString::Printf(TEXT("\t{ \"targets\": %d, \"sockets\": %d, \"stage\": \"%s\", \"meanUs\": %.3f, \"p50Us\": %.3f, \"p90Us\": %.3f, \"p99Us\": %.3f, \"maxUs\": %.3f }%s\n"),
+		                        result.NumTargets, result.NumSockets, *result.Stage, result.Mean, result.P50, result.P90, result.P99, result.Max, i + 1 < Results.Num() ? TEXT(",") : TEXT(""));
+	}
+
+	json += TEXT("]\n");
+
+	const auto bWritten = FFileHelper::SaveStringToFile(csv, *(OutputPath + TEXT(".csv"))) && FFileHelper::SaveStringToFile(json, *(OutputPath + TEXT(".json")));
+
+	if (!bWritten)
+	{
+		UE_LOG(LogAimAssistBenchmark, Error, TEXT("Failed to write benchmark reports to %s"), *OutputPath);
+	}
+
+	return bWritten;
+}
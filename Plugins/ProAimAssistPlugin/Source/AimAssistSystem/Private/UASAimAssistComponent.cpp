@@ -6,6 +6,7 @@
 #include "Algo/NoneOf.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/Canvas.h"
+#include "Framework/Application/SlateApplication.h"
 #include "GameFramework/Actor.h"
 #include "GameFramework/HUD.h"
 #include "GameFramework/PawnMovementComponent.h"
@@ -15,31 +16,255 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "TimerManager.h"
 #include "Misc/App.h"
+#include "SceneView.h"
 #include "UASAimAssistConfigDataAsset.h"
+#include "UASAimAssistStageTimings.h"
 #include "UASAimAssistTargetComponent.h"
+#include "UASAimAssistTargetSubsystem.h"
+#include "UASAimAssistTelemetry.h"
 
 DEFINE_STAT(STAT_HandleTargets);
 DEFINE_STAT(STAT_UpdateTargets);
 DEFINE_STAT(STAT_HandleAutoAim);
 DEFINE_STAT(STAT_HandleCurrentTarget);
+DEFINE_STAT(STAT_TraceVisibility);
 
-FVector2D FUASAimAssistTargetData::GetLocationOnTheScreen(APlayerController* Controller) const
+static TAutoConsoleVariable<bool> CVarAimAssistAsyncScoring(
+	TEXT("AimAssist.AsyncScoring"),
+	false,
+	TEXT("Score aim assist candidates on a worker task and apply the result on the next component tick."),
+	ECVF_Default);
+
+static void ProjectLocationsToScreen(const FMatrix& ViewProjectionMatrix, const FIntRect& ViewRect, TConstArrayView<FVector> WorldLocations, TArray<FVector2D>& OutScreenLocations)
 {
-	FVector2D location;
-	UGameplayStatics::ProjectWorldToScreen(Controller, GetSocketLocation(), location);
-	return location;
+	OutScreenLocations.SetNumUninitialized(WorldLocations.Num(), false);
+
+	// Same mapping as FSceneView::ProjectWorldToScreen with the view rect terms hoisted out of the loop,
+	// TransformFVector4 runs on vector registers.
+	const FVector2D halfSize(ViewRect.Width() * 0.5f, ViewRect.Height() * 0.5f);
+	const FVector2D center(ViewRect.Min.X + halfSize.X, ViewRect.Min.Y + halfSize.Y);
+
+	for (int32 i = 0; i < WorldLocations.Num(); ++i)
+	{
+		const auto result = ViewProjectionMatrix.TransformFVector4(FVector4(WorldLocations[i], 1.f));
+
+		if (result.W > 0.f)
+		{
+			const auto rhw = 1.f / result.W;
+			OutScreenLocations[i] = FVector2D(center.X + result.X * rhw * halfSize.X, center.Y - result.Y * rhw * halfSize.Y);
+		}
+		else
+		{
+			OutScreenLocations[i] = FVector2D::ZeroVector;
+		}
+	}
+}
+
+static int32 FindClosestToScreenCenter(TConstArrayView<FVector2D> ScreenLocations, const FVector2D& ScreenCenter)
+{
+	auto bestIndex = INDEX_NONE;
+	auto bestDistance = TNumericLimits<float>::Max();
+
+	for (int32 i = 0; i < ScreenLocations.Num(); ++i)
+	{
+		const auto distance = FVector2D::DistSquared(ScreenLocations[i], ScreenCenter);
+
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			bestIndex = i;
+		}
+	}
+
+	return bestIndex;
+}
+
+void FUASAimAssistTargetTable::Schedule(UUASAimAssistTargetComponent* Component, int32 NumRows, uint32 Generation, double NextEvaluationTime)
+{
+	auto& schedule = Schedules.FindOrAdd(Component->GetUniqueID());
+
+	// The target evaluates fewer sockets than before, the rows it stopped touching would keep stale locations and visibility.
+	for (int32 socketIndex = NumRows; socketIndex < schedule.NumRows; ++socketIndex)
+	{
+		if (const auto row = RowsByKey.Find(MakeKey(Component, socketIndex)))
+		{
+			RemoveAtSwap(*row);
+		}
+	}
+
+	schedule.Component = Component;
+	schedule.NextEvaluationTime = NextEvaluationTime;
+	schedule.NumRows = NumRows;
+	schedule.Generation = Generation;
+}
+
+int32 FUASAimAssistTargetTable::Touch(UUASAimAssistTargetComponent* Component, const FUASSocketData& Socket, uint32 Generation)
+{
+	const auto key = MakeKey(Component, Socket.SocketIndex);
+
+	if (const auto row = RowsByKey.Find(key))
+	{
+		// Unique ids are recycled after garbage collection, so the row may still point at a dead component.
+		if (Components[*row] != Component)
+		{
+			Actors[*row] = Component->GetOwner();
+			Components[*row] = Component;
+		}
+
+		Locations[*row] = Socket.Location;
+		Generations[*row] = Generation;
+		Evaluated[*row] = true;
+		return *row;
+	}
+
+	const auto newRow = Keys.Add(key);
+	RowsByKey.Add(key, newRow);
+	Actors.Add(Component->GetOwner());
+	Components.Add(Component);
+	SocketIndices.Add(Socket.SocketIndex);
+	Locations.Add(Socket.Location);
+	Generations.Add(Generation);
+	Evaluated.Add(true);
+	Visibilities.Add(false);
+
+	return newRow;
+}
+
+bool FUASAimAssistTargetTable::KeepIfScheduled(const UUASAimAssistTargetComponent* Component, uint32 Generation, double Now)
+{
+	const auto schedule = Schedules.Find(Component->GetUniqueID());
+
+	if (schedule == nullptr || schedule->Component != Component || schedule->NextEvaluationTime <= Now)
+	{
+		return false;
+	}
+
+	schedule->Generation = Generation;
+
+	// Sockets are evaluated as a prefix of the socket list, a row missing from the prefix was never touched.
+	for (int32 socketIndex = 0; socketIndex < schedule->NumRows; ++socketIndex)
+	{
+		if (const auto row = RowsByKey.Find(MakeKey(Component, socketIndex)))
+		{
+			Generations[*row] = Generation;
+			Evaluated[*row] = false;
+		}
+	}
+
+	return true;
+}
+
+void FUASAimAssistTargetTable::CollectDueTargets(double Now, TArray<UUASAimAssistTargetComponent*>& OutComponents)
+{
+	OutComponents.Reset();
+
+	for (int32 row = 0; row < Num(); ++row)
+	{
+		Evaluated[row] = false;
+
+		const auto component = Components[row].Get();
+
+		if (component == nullptr || !component->IsTargetActive())
+		{
+			Visibilities[row] = false;
+		}
+	}
+
+	for (const auto& pair : Schedules)
+	{
+		const auto component = pair.Value.Component.Get();
+
+		if (component != nullptr && component->IsTargetActive() && pair.Value.NextEvaluationTime <= Now)
+		{
+			OutComponents.Add(component);
+		}
+	}
+}
+
+void FUASAimAssistTargetTable::RemoveStale(uint32 Generation)
+{
+	for (int32 row = Num() - 1; row >= 0; --row)
+	{
+		if (Generations[row] != Generation)
+		{
+			RemoveAtSwap(row);
+		}
+	}
+
+	for (auto it = Schedules.CreateIterator(); it; ++it)
+	{
+		if (it.Value().Generation != Generation)
+		{
+			it.RemoveCurrent();
+		}
+	}
+}
+
+void FUASAimAssistTargetTable::Reset()
+{
+	Actors.Reset();
+	Components.Reset();
+	SocketIndices.Reset();
+	Locations.Reset();
+	Generations.Reset();
+	Evaluated.Reset();
+	Visibilities.Reset();
+	Keys.Reset();
+	RowsByKey.Reset();
+	Schedules.Reset();
+}
+
+void FUASAimAssistTargetTable::RemoveAtSwap(int32 Row)
+{
+	RowsByKey.Remove(Keys[Row]);
+
+	Actors.RemoveAtSwap(Row, 1, false);
+	Components.RemoveAtSwap(Row, 1, false);
+	SocketIndices.RemoveAtSwap(Row, 1, false);
+	Locations.RemoveAtSwap(Row, 1, false);
+	Generations.RemoveAtSwap(Row, 1, false);
+	Evaluated.RemoveAtSwap(Row, 1, false);
+	Visibilities.RemoveAtSwap(Row, 1, false);
+	Keys.RemoveAtSwap(Row, 1, false);
+
+	if (Keys.IsValidIndex(Row))
+	{
+		RowsByKey[Keys[Row]] = Row;
+	}
+}
+
+uint64 FUASAimAssistTargetTable::MakeKey(const UUASAimAssistTargetComponent* Component, int32 SocketIndex)
+{
+	return (uint64(Component->GetUniqueID()) << 32) | uint32(SocketIndex);
 }
 
 FVector FUASAimAssistTargetData::GetSocketLocation() const
 {
 	if (IsValid())
 	{
-		return TargetComponent->GetMesh()->GetSocketLocation(SocketName);
+		return TargetComponent->GetAimTargetSocketLocation(SocketIndex);
 	}
 
 	return FVector::ZeroVector;
 }
 
+FVector FUASAimAssistTargetData::GetPredictedSocketLocation(float LeadTime) const
+{
+	if (!IsValid())
+	{
+		return FVector::ZeroVector;
+	}
+
+	const auto location = TargetComponent->GetAimTargetSocketLocation(SocketIndex);
+
+	if (LeadTime <= 0.f)
+	{
+		return location;
+	}
+
+	return location + TargetComponent->GetAimTargetSocketVelocity(SocketIndex) * LeadTime;
+}
+
 bool FUASAimAssistTargetData::IsValid() const
 {
 	return TargetComponent.IsValid() && TargetComponent->GetMesh() != nullptr;
@@ -48,6 +273,9 @@ bool FUASAimAssistTargetData::IsValid() const
 UUASAimAssistComponent::UUASAimAssistComponent()
 {
 	PrimaryComponentTick.bCanEverTick = true;
+
+	// Only for ServerReportDataAsset, nothing on the component replicates.
+	SetIsReplicatedByDefault(true);
 }
 
 void UUASAimAssistComponent::BeginPlay()
@@ -68,18 +296,23 @@ void UUASAimAssistComponent::BeginPlay()
 	}
 
 	SetAimAssistDataAsset(AimAssistDataAsset);
+
+	if (auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>())
+	{
+		subsystem->RegisterView(this);
+	}
 	
 	if (PlayerController.IsValid())
 	{
 		CrosshairPosition = GetScreenCenter();
 		CrosshairPositionDebug = CrosshairPosition;
 		
-		FViewport::ViewportResizedEvent.AddLambda([&](FViewport* Viewport, uint32) {
-			if (this && PlayerController.IsValid() && GetWorld() && GetWorld()->GetGameViewport() && GetWorld()->GetGameViewport()->Viewport == Viewport && AimAssistDataAsset)
-			{
-				CrosshairPositionDebug = GetScreenCenter();
-			}
-		});
+		ViewportResizedHandle = FViewport::ViewportResizedEvent.AddUObject(this, &UUASAimAssistComponent::OnViewportResized);
+
+		if (FSlateApplication::IsInitialized())
+		{
+			WindowDPIScaleChangedHandle = FSlateApplication::Get().OnWindowDPIScaleChanged().AddUObject(this, &UUASAimAssistComponent::OnWindowDPIScaleChanged);
+		}
 
 #if !UE_BUILD_SHIPPING
 		if (PlayerController->GetHUD() != nullptr && PlayerController->GetHUD()->bShowHUD && FApp::CanEverRender())
@@ -90,283 +323,1074 @@ void UUASAimAssistComponent::BeginPlay()
 	}
 }
 
-void UUASAimAssistComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+void UUASAimAssistComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>())
+	{
+		subsystem->UnregisterView(this);
+	}
+
+	FViewport::ViewportResizedEvent.Remove(ViewportResizedHandle);
+
+	if (FSlateApplication::IsInitialized())
+	{
+		FSlateApplication::Get().OnWindowDPIScaleChanged().Remove(WindowDPIScaleChangedHandle);
+	}
+
+	if (ScoringTask.IsValid())
+	{
+		ScoringTask.Wait();
+		ScoringTask = {};
+	}
+
+	StopTelemetryRecording();
+
+	PendingTargets.Reset();
+	PendingTargetIndex = 0;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UUASAimAssistComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	ApplyScoringResult();
+
+	if (AimAssistDataAsset == nullptr || !PlayerController.IsValid() || PlayerController->GetPawn() == nullptr)
+	{
+		return;
+	}
+
+	if (!ViewState.bValid || ViewState.bScaledByDPI != bScalingByDPI)
+	{
+		RefreshViewState();
+	}
+
+	if (AimAssistDataAsset->bTargetLOD)
+	{
+		// Every target keeps its own schedule, the shared pass runs each frame to serve the ones that are due.
+		UpdateAssist();
+	}
+	else if (AimAssistDataAsset->bAdaptiveTargetsUpdate)
+	{
+		UpdateAdaptiveSchedule(DeltaTime);
+	}
+
+	if (AimAssistDataAsset->bTargetHysteresis)
+	{
+		ValidateCurrentTarget();
+	}
+
+	// Toggles of the config can be written through GetAimAssistDataAsset or by other components sharing it.
+	if (GetRequestedFeatures() != EnabledFeatures)
+	{
+		UpdatePipeline();
+	}
+
+	// Auto aim turns the camera during evaluation, the recording keeps the rotation the player left it at.
+	const auto controlRotation = PlayerController->GetControlRotation();
+
+	(this->*EvaluateFunction)(DeltaTime);
+
+	if (TelemetryRecorder.IsValid())
+	{
+		RecordTelemetry(DeltaTime, controlRotation);
+	}
+
+#if !UE_BUILD_SHIPPING
+	DrawDebug(DeltaTime);
+#endif
+}
+
+bool UUASAimAssistComponent::StartTelemetryRecording(const FString& FileName)
+{
+	StopTelemetryRecording();
+
+	if (!PlayerController.IsValid())
+	{
+		return false;
+	}
+
+	auto filePath = FileName;
+
+	if (FPaths::IsRelative(filePath))
+	{
+		filePath = FPaths::ProjectSavedDir() / TEXT("AimAssistTelemetry") / filePath;
+	}
+
+	if (FPaths::GetExtension(filePath).IsEmpty())
+	{
+		filePath += TEXT(".uastelemetry");
+	}
+
+	TelemetryRecorder = MakeShared<FUASAimAssistTelemetryRecorder>();
+
+	if (!TelemetryRecorder->Start(filePath))
+	{
+		TelemetryRecorder.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+void UUASAimAssistComponent::StopTelemetryRecording()
+{
+	if (TelemetryRecorder.IsValid())
+	{
+		TelemetryRecorder->Stop();
+		TelemetryRecorder.Reset();
+	}
+}
+
+void UUASAimAssistComponent::RecordTelemetry(float DeltaTime, const FRotator& ControlRotation)
+{
+	UpdateViewProjection();
+
+	auto& frame = TelemetryFrame;
+	frame.Reset();
+	frame.Time = GetWorld()->GetTimeSeconds();
+	frame.DeltaTime = DeltaTime;
+	frame.bTargetsRefreshed = bTelemetryTargetsRefreshed;
+	frame.ControlRotation = ControlRotation;
+	frame.ViewProjectionMatrix = ViewProjectionMatrix;
+	frame.ViewRect = ViewRect;
+	frame.CrosshairPosition = CrosshairPosition;
+	PlayerController->GetPlayerViewPoint(frame.CameraLocation, frame.CameraRotation);
+
+	for (int32 i = 0; i < LastTargetData.Num(); ++i)
+	{
+		if (!LastTargetData[i].IsValid())
+		{
+			continue;
+		}
+
+		if (LastTargetData[i] == CurrentTargetData)
+		{
+			frame.CurrentCandidate = frame.CandidateLocations.Num();
+		}
+
+		const auto location = LastTargetData[i].GetSocketLocation();
+		frame.CandidateLocations.Add(location);
+		frame.CandidateScreenLocations.Add(ProjectToScreen(location));
+		frame.CandidateIds.Add((static_cast<uint64>(LastTargetData[i].TargetComponent->GetUniqueID()) << 32) | static_cast<uint32>(LastTargetData[i].SocketIndex));
+	}
+
+	auto activeZones = EUASAimAssistFeatures::None;
+
+	if (bStickinessAreaActive)
+	{
+		activeZones |= EUASAimAssistFeatures::Stickiness;
+	}
+
+	if (bMagnetismAreaActive)
+	{
+		activeZones |= EUASAimAssistFeatures::Magnetism;
+	}
+
+	if (bAutoAimAreaActive)
+	{
+		activeZones |= EUASAimAssistFeatures::AutoAim;
+	}
+
+	frame.ActiveZones = static_cast<uint8>(activeZones);
+	GetControlMultipliers(frame.PitchMultiplier, frame.YawMultiplier);
+
+	TelemetryRecorder->Record(frame);
+	bTelemetryTargetsRefreshed = false;
+}
+
+FRotator UUASAimAssistComponent::GetRotationToCrosshairDirection(const FVector& From, FName TraceProfileName, float Distance) const
+{
+	if (PlayerController.IsValid())
+	{
+		FVector worldOrigin;
+		FVector worldDirection;
+
+		const auto crosshairPosition = (AimAssistDataAsset && CurrentTargetData.IsValid()) ? CrosshairPosition : GetScreenCenter();
+		
+		if (UGameplayStatics::DeprojectScreenToWorld(PlayerController.Get(), crosshairPosition, worldOrigin, worldDirection))
+		{
+			auto target = FVector::ZeroVector;
+			if (CurrentTargetData.IsValid() && bMagnetismAreaActive)
+			{
+				target = worldOrigin + worldDirection * (worldOrigin - CurrentTargetData.GetSocketLocation()).Size();
+			}
+			else
+			{
+				FHitResult hitResult;
+
+				UKismetSystemLibrary::LineTraceSingleByProfile(this,
+				                                               worldOrigin,
+				                                               worldOrigin + worldDirection * Distance,
+				                                               TraceProfileName,
+				                                               false,
+				                                               { GetOwner() },
+				                                               EDrawDebugTrace::None,
+				                                               hitResult,
+				                                               true);
+
+				target = hitResult.bBlockingHit ? hitResult.Location : FVector::ZeroVector;
+			}
+
+			if (!target.IsZero())
+			{
+				return UKismetMathLibrary::FindLookAtRotation(From, target);
+			}
+
+			return worldDirection.Rotation();
+		}
+	}
+
+	return FRotator::ZeroRotator;
+}
+
+void UUASAimAssistComponent::SetAimAssistDataAsset(UUASAimAssistConfigDataAsset* DataAsset)
+{
+	if (PlayerController.IsValid())
+	{
+		AimAssistDataAsset = DataAsset != nullptr ? DuplicateObject<UUASAimAssistConfigDataAsset>(DataAsset, this) : nullptr;
+
+		// The copy only exists on this machine, the server is told about the asset it was made from.
+		ServerReportDataAsset(DataAsset);
+
+		if (AimAssistDataAsset != nullptr)
+		{
+			AimAssistDataAsset->BakeCurves();
+		}
+
+		UpdatePipeline();
+		RefreshViewState();
+
+		OnAimDataAssetChangedDelegate.Broadcast(AimAssistDataAsset);
+
+		GetWorld()->GetTimerManager().ClearTimer(UpdateTargetsTimerHandle);
+
+		TimeSinceTargetsUpdate = 0.f;
+		AdaptiveUpdateInterval = 0.f;
+		PendingTargets.Reset();
+		PendingTargetIndex = 0;
+
+		if (AimAssistDataAsset != nullptr && !AimAssistDataAsset->bAdaptiveTargetsUpdate && !AimAssistDataAsset->bTargetLOD)
+		{
+			GetWorld()->GetTimerManager().SetTimer(UpdateTargetsTimerHandle, FTimerDelegate::CreateUObject(this, &UUASAimAssistComponent::UpdateAssist), AimAssistDataAsset->UpdateTargetsRate, true);
+		}
+	
+	}
+}
+
+void UUASAimAssistComponent::UpdateAssist()
+{
+	if (!CanUpdateTargets())
+	{
+		return;
+	}
+
+	// A held target is re-validated every tick, the full scan only looks for a better one.
+	if (AimAssistDataAsset->bTargetHysteresis && CurrentTargetData.IsValid() && GetWorld()->GetTimeSeconds() - LastFullScanTime < AimAssistDataAsset->FullScanRate)
+	{
+		return;
+	}
+
+	// Views requesting a refresh in the same frame share one gathering and trace pass.
+	bTargetsRefreshRequested = true;
+	bTelemetryTargetsRefreshed = true;
+}
+
+void UUASAimAssistComponent::UpdateAdaptiveSchedule(float DeltaTime)
+{
+	TimeSinceTargetsUpdate += DeltaTime;
+
+	const auto minInterval = AimAssistDataAsset->MinUpdateTargetsRate;
+	const auto maxInterval = FMath::Max(AimAssistDataAsset->MaxUpdateTargetsRate, minInterval);
+
+	if (TimeSinceTargetsUpdate < minInterval)
+	{
+		return;
+	}
+
+	FVector viewLocation;
+	FRotator viewRotation;
+	PlayerController->GetPlayerViewPoint(viewLocation, viewRotation);
+
+	const auto viewQuat = viewRotation.Quaternion();
+	const auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>();
+	const auto targetsGeneration = subsystem != nullptr ? subsystem->GetTargetsGeneration() : 0;
+
+	const auto bViewChanged = FMath::RadiansToDegrees(viewQuat.AngularDistance(LastUpdateViewRotation)) >= AimAssistDataAsset->RefreshRotationThreshold
+	                          || FVector::DistSquared(viewLocation, LastUpdateViewLocation) >= FMath::Square(AimAssistDataAsset->RefreshTranslationThreshold);
+	const auto bTargetsChanged = targetsGeneration != LastUpdateTargetsGeneration;
+
+	if (bViewChanged || bTargetsChanged)
+	{
+		AdaptiveUpdateInterval = minInterval;
+	}
+	else if (TimeSinceTargetsUpdate < AdaptiveUpdateInterval)
+	{
+		return;
+	}
+	else
+	{
+		// Nothing moved since the last refresh, wait twice as long for the next one.
+		AdaptiveUpdateInterval = FMath::Clamp(AdaptiveUpdateInterval * 2.f, minInterval, maxInterval);
+	}
+
+	TimeSinceTargetsUpdate = 0.f;
+	LastUpdateViewLocation = viewLocation;
+	LastUpdateViewRotation = viewQuat;
+	LastUpdateTargetsGeneration = targetsGeneration;
+
+	UpdateAssist();
+}
+
+bool UUASAimAssistComponent::CanUpdateTargets() const
+{
+	return AimAssistDataAsset != nullptr && PlayerController.IsValid() && PlayerController->GetPawn() != nullptr;
+}
+
+void UUASAimAssistComponent::ServerReportDataAsset_Implementation(UUASAimAssistConfigDataAsset* DataAsset)
+{
+	ReportedDataAsset = DataAsset;
+}
+
+bool UUASAimAssistComponent::CanUseAssist() const
+{
+	if (PlayerController.IsValid() && PlayerController->IsLocalController()
+		&& ((PlayerController->GetLocalRole() == ENetRole::ROLE_AutonomousProxy && GetWorld()->GetNetMode() == NM_Client)
+		|| (PlayerController->GetLocalRole() == ENetRole::ROLE_Authority && GetWorld()->GetNetMode() != NM_Client && GetWorld()->GetNetMode() != NM_DedicatedServer))
+		)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+void UUASAimAssistComponent::UpdateTargets()
+{
+	UAS_SCOPE_AIM_ASSIST_STAGE(UpdateTargets);
+
+	auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>();
+
+	if (subsystem == nullptr)
+	{
+		TargetTable.Reset();
+		return;
+	}
+
+	const auto now = GetWorld()->GetTimeSeconds();
+
+	// Between grid queries the targets that are not due are neither queried nor projected, their rows carry over as they are.
+	if (AimAssistDataAsset->bTargetLOD && now < NextLODQueryTime)
+	{
+		TargetTable.CollectDueTargets(now, QueriedTargets);
+
+		UpdateTargetsContext();
+
+		for (const auto component : QueriedTargets)
+		{
+			UpdateTarget(component);
+		}
+
+		return;
+	}
+
+	subsystem->QueryTargets(GetOverlapLocation(), GetOverlapRotation().Quaternion(), GetOverlapExtents(), PlayerController->GetPawn(), QueriedTargets);
+
+	PendingTargets.Reset();
+	++TargetTableGeneration;
+	LastFullScanTime = now;
+	NextLODQueryTime = now + AimAssistDataAsset->TargetLODQueryRate;
+
+	UpdateTargetsContext();
+
+	for (const auto component : QueriedTargets)
+	{
+		UpdateTarget(component);
+	}
+
+	TargetTable.RemoveStale(TargetTableGeneration);
+}
+
+void UUASAimAssistComponent::UpdateTargetsContext()
+{
+	UpdateViewProjection();
+
+	TargetsContext.ScreenCenter = GetScreenCenter();
+	TargetsContext.ZoneRadius = GetLargestScaledZoneRadius();
+	TargetsContext.ViewLocation = GetCameraLocation();
+	TargetsContext.Now = GetWorld()->GetTimeSeconds();
+	TargetsContext.bLOD = AimAssistDataAsset->bTargetLOD;
+}
+
+void UUASAimAssistComponent::UpdateTarget(UUASAimAssistTargetComponent* Component, TArray<int32>* OutTouchedRows)
+{
+	const auto bounds = Component->GetMesh()->Bounds.GetSphere();
+
+	// Coarse phase, a target whose whole bounds project outside every zone never gets its sockets read or traced.
+	// Its rows from an earlier evaluation are retired so they cannot stay visible, and it is due again on the next pass.
+	if (IsOutsideZones(bounds, TargetsContext.ScreenCenter, TargetsContext.ZoneRadius))
+	{
+		TargetTable.Schedule(Component, 0, TargetTableGeneration, TargetsContext.Now);
+		return;
+	}
+
+	if (TargetsContext.bLOD && TargetTable.KeepIfScheduled(Component, TargetTableGeneration, TargetsContext.Now))
+	{
+		return;
+	}
+
+	Component->GetAimTargetSocketLocations(SocketLocations);
+
+	auto numSockets = SocketLocations.Num();
+	auto nextEvaluationTime = TargetsContext.Now;
+
+	if (TargetsContext.bLOD && numSockets != 0)
+	{
+		const auto relevance = GetTargetRelevance(bounds.Center, TargetsContext.ViewLocation, TargetsContext.ScreenCenter);
+		const auto socketsFraction = GetCurveValue(AimAssistDataAsset->TargetLODSocketsCurve, AimAssistDataAsset->TargetLODSocketsLookupTable, relevance);
+
+		nextEvaluationTime += GetCurveValue(AimAssistDataAsset->TargetLODIntervalCurve, AimAssistDataAsset->TargetLODIntervalLookupTable, relevance);
+		numSockets = FMath::Clamp(FMath::CeilToInt(socketsFraction * numSockets), 1, numSockets);
+	}
+
+	TargetTable.Schedule(Component, numSockets, TargetTableGeneration, nextEvaluationTime);
+
+	for (int32 i = 0; i < numSockets; ++i)
+	{
+		const auto row = TargetTable.Touch(Component, SocketLocations[i], TargetTableGeneration);
+
+		if (OutTouchedRows != nullptr)
+		{
+			OutTouchedRows->Add(row);
+		}
+	}
+}
+
+void UUASAimAssistComponent::BeginTimeSlicedUpdate()
+{
+	auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>();
+
+	if (subsystem == nullptr)
+	{
+		TargetTable.Reset();
+		return;
+	}
+
+	subsystem->QueryTargets(GetOverlapLocation(), GetOverlapRotation().Quaternion(), GetOverlapExtents(), PlayerController->GetPawn(), QueriedTargets);
+
+	PendingTargets.Reset(QueriedTargets.Num());
+	PendingTargets.Append(QueriedTargets);
+	PendingTargetIndex = 0;
+
+	++TargetTableGeneration;
+	LastFullScanTime = GetWorld()->GetTimeSeconds();
+}
+
+void UUASAimAssistComponent::ProcessTimeSlice()
+{
+	UAS_SCOPE_AIM_ASSIST_STAGE(UpdateTargets);
+
+	const auto deadline = FPlatformTime::Seconds() + AimAssistDataAsset->FrameBudgetMicroseconds * 0.000001;
+	const auto bAsyncObstacleChecks = AimAssistDataAsset->bAsyncObstacleChecks;
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(AimAssistObstacleCheck), false);
+
+	UpdateTargetsContext();
+
+	// At least one target per slice, a budget below the cost of a single target still makes progress.
+	do
+	{
+		const auto component = PendingTargets[PendingTargetIndex++].Get();
+
+		if (component == nullptr || !component->IsTargetActive())
+		{
+			continue;
+		}
+
+		TouchedRows.Reset();
+		UpdateTarget(component, bAsyncObstacleChecks ? nullptr : &TouchedRows);
+
+		for (const auto row : TouchedRows)
+		{
+			if (IsRowCulled(row))
+			{
+				TargetTable.Visibilities[row] = false;
+				continue;
+			}
+
+			// The target actor is ignored like the owner, so only another actor can block the socket.
+			queryParams.ClearIgnoredActors();
+			queryParams.AddIgnoredActor(GetOwner());
+			queryParams.AddIgnoredActor(TargetTable.Actors[row].Get());
+
+			FHitResult hitResult;
+			GetWorld()->LineTraceSingleByProfile(hitResult, TargetsContext.ViewLocation, TargetTable.Locations[row], ObstacleCheckProfileName, queryParams);
+			TargetTable.Visibilities[row] = !hitResult.bBlockingHit;
+
+#if ENABLE_DRAW_DEBUG
+			if (bDebugTargetTraces)
+			{
+				::DrawDebugLine(GetWorld(), TargetsContext.ViewLocation, TargetTable.Locations[row], TargetTable.Visibilities[row] ? FColor::Green : FColor::Red, false, 5.f);
+			}
+#endif
+		}
+	} while (IsTimeSlicedUpdatePending() && FPlatformTime::Seconds() < deadline);
+
+	// Mid cycle the candidates and the target of the previous cycle stay as they are, only a finished scoring is picked up.
+	if (IsTimeSlicedUpdatePending())
+	{
+		ApplyScoringResult();
+		return;
+	}
+
+	PendingTargets.Reset();
+	PendingTargetIndex = 0;
+	TargetTable.RemoveStale(TargetTableGeneration);
+
+	// Async obstacle checks of the whole cycle join the next batch of the shared pass, which selects the target once they are back.
+	if (bAsyncObstacleChecks)
+	{
+		bTimeSlicedTracesRequested = true;
+		return;
+	}
+
+	GatherVisibleTargets();
+	SelectCurrentTarget();
+}
+
+bool UUASAimAssistComponent::IsRowCulled(int32 Row) const
+{
+	return AimAssistDataAsset->bCullNotRenderedTargets && FApp::CanEverRender()
+	       && !TargetTable.Components[Row]->GetMesh()->WasRecentlyRendered(AimAssistDataAsset->RenderedRecentlyTolerance);
+}
+
+void UUASAimAssistComponent::AddVisibilityTraces(TArray<FUASVisibilityTrace>& OutTraces, int32 ViewIndex)
+{
+	const FVector viewLocation = GetCameraLocation();
+
+	// Rows were refreshed by UpdateTargets earlier in the same pass, so they all point at live targets.
+	for (int32 row = 0; row < TargetTable.Num(); ++row)
+	{
+		if (!TargetTable.Evaluated[row])
+		{
+			continue;
+		}
+
+		if (IsRowCulled(row))
+		{
+			TargetTable.Visibilities[row] = false;
+			continue;
+		}
+
+		auto& trace = OutTraces.AddDefaulted_GetRef();
+		trace.Start = viewLocation;
+		trace.End = TargetTable.Locations[row];
+		trace.TargetData = { TargetTable.Components[row], TargetTable.SocketIndices[row] };
+		trace.TargetActor = TargetTable.Actors[row];
+		trace.ViewIndex = ViewIndex;
+		trace.TableRow = row;
+	}
+}
+
+void UUASAimAssistComponent::GatherVisibleTargets()
+{
+	LastTargetData.Reset();
+
+	for (int32 row = 0; row < TargetTable.Num(); ++row)
+	{
+		if (TargetTable.Visibilities[row] && TargetTable.Components[row].IsValid())
+		{
+			LastTargetData.Add({ TargetTable.Components[row], TargetTable.SocketIndices[row] });
+		}
+	}
+}
+
+float UUASAimAssistComponent::GetTargetRelevance(const FVector& Location, const FVector& ViewLocation, const FVector2D& ScreenCenter) const
+{
+	const auto distance = FMath::Clamp(FVector::Dist(Location, ViewLocation) / FMath::Max(AimAssistDataAsset->AimAreaExtents.X, 1.f), 0.f, 1.f);
+
+	auto screenDistance = 1.f;
+	const auto result = ViewProjectionMatrix.TransformFVector4(FVector4(Location, 1.f));
+
+	if (bViewProjectionValid && result.W > 0.f)
+	{
+		const auto rhw = 1.f / result.W;
+		const FVector2D location(ViewRect.Min.X + ViewRect.Width() * 0.5f * (1.f + result.X * rhw), ViewRect.Min.Y + ViewRect.Height() * 0.5f * (1.f - result.Y * rhw));
+		const auto halfDiagonal = FMath::Max(FVector2D(ViewRect.Width(), ViewRect.Height()).Size() * 0.5f, 1.f);
+
+		screenDistance = FMath::Min(FVector2D::Distance(location, ScreenCenter) / halfDiagonal, 1.f);
+	}
+
+	return (1.f - distance) * (1.f - screenDistance);
+}
+
+void UUASAimAssistComponent::SelectCurrentTarget()
+{
+	ApplyScoringResult();
+
+	// The previous scoring has not finished yet, keep its target and score the candidates again once it is applied.
+	if (ScoringTask.IsValid())
+	{
+		return;
+	}
+
+	UpdateViewProjection();
+
+	if (LastTargetData.Num() == 0 || !bViewProjectionValid)
+	{
+		CurrentTargetData = {};
+		return;
+	}
+
+	// Snapshot everything the scoring needs into a buffer of its own, the socket cache is game thread only.
+	FScoringBuffer buffer;
+	buffer.Targets = LastTargetData;
+	buffer.WorldLocations.Reserve(LastTargetData.Num());
+
+	for (const auto& data : LastTargetData)
+	{
+		buffer.WorldLocations.Add(data.GetSocketLocation());
+	}
+
+	if (CVarAimAssistAsyncScoring.GetValueOnGameThread())
+	{
+		ScoringTask = UE::Tasks::Launch(TEXT("AimAssistScoring"), [buffer = MoveTemp(buffer), viewProjectionMatrix = ViewProjectionMatrix, viewRect = ViewRect, screenCenter = GetScreenCenter()]() mutable {
+			ProjectLocationsToScreen(viewProjectionMatrix, viewRect, buffer.WorldLocations, buffer.ScreenLocations);
+			buffer.BestIndex = FindClosestToScreenCenter(buffer.ScreenLocations, screenCenter);
+			return MoveTemp(buffer);
+		});
+		return;
+	}
+
+	ProjectLocationsToScreen(ViewProjectionMatrix, ViewRect, buffer.WorldLocations, buffer.ScreenLocations);
+	buffer.BestIndex = FindClosestToScreenCenter(buffer.ScreenLocations, GetScreenCenter());
+
+	Swap(ScoringBuffer, buffer);
+
+	const auto bestIndex = ApplyHysteresis(ScoringBuffer.BestIndex, GetScreenCenter(), ScoringBuffer.Targets, ScoringBuffer.ScreenLocations);
+	CurrentTargetData = ScoringBuffer.Targets.IsValidIndex(bestIndex) ? ScoringBuffer.Targets[bestIndex] : FUASAimAssistTargetData();
+}
+
+void UUASAimAssistComponent::ApplyScoringResult()
+{
+	// Never wait on the worker, an unfinished scoring keeps the previous target for this frame.
+	if (!ScoringTask.IsValid() || !ScoringTask.IsCompleted())
+	{
+		return;
+	}
+
+	Swap(ScoringBuffer, ScoringTask.GetResult());
+	ScoringTask = {};
+
+	const auto bestIndex = ApplyHysteresis(ScoringBuffer.BestIndex, GetScreenCenter(), ScoringBuffer.Targets, ScoringBuffer.ScreenLocations);
+	CurrentTargetData = ScoringBuffer.Targets.IsValidIndex(bestIndex) ? ScoringBuffer.Targets[bestIndex] : FUASAimAssistTargetData();
+}
+
+int32 UUASAimAssistComponent::ApplyHysteresis(int32 BestIndex, const FVector2D& ScreenCenter, TConstArrayView<FUASAimAssistTargetData> Targets, TConstArrayView<FVector2D> ScreenLocations) const
+{
+	if (AimAssistDataAsset == nullptr || !AimAssistDataAsset->bTargetHysteresis || !CurrentTargetData.IsValid() || !ScreenLocations.IsValidIndex(BestIndex))
+	{
+		return BestIndex;
+	}
+
+	const auto currentIndex = Targets.IndexOfByKey(CurrentTargetData);
+
+	if (currentIndex == INDEX_NONE || currentIndex == BestIndex)
+	{
+		return BestIndex;
+	}
+
+	// The candidate has to beat the held target by the margin, otherwise two close targets swap every scan.
+	const auto currentDistance = FVector2D::Distance(ScreenLocations[currentIndex], ScreenCenter);
+	const auto bestDistance = FVector2D::Distance(ScreenLocations[BestIndex], ScreenCenter);
+
+	return currentDistance <= bestDistance + AimAssistDataAsset->HysteresisScreenMargin ? currentIndex : BestIndex;
+}
+
+void UUASAimAssistComponent::ValidateCurrentTarget()
+{
+	if (!CurrentTargetData.IsValid() || ScoringTask.IsValid())
+	{
+		return;
+	}
+
+	UpdateViewProjection();
+
+	const auto socketLocation = CurrentTargetData.GetSocketLocation();
+	const auto screenDistance = FVector2D::Distance(ProjectToScreen(socketLocation), GetScreenCenter());
+	auto bLost = !bViewProjectionValid || screenDistance > GetLargestScaledZoneRadius() + AimAssistDataAsset->HysteresisScreenMargin;
+
+	if (!bLost && AimAssistDataAsset->bAsyncObstacleChecks)
+	{
+		// The obstacle check joins the next batch of the shared pass, the target is dropped once its result comes back blocked.
+		bTargetValidationRequested = true;
+		return;
+	}
+
+	if (!bLost)
+	{
+		FHitResult hitResult;
+		FCollisionQueryParams queryParams(SCENE_QUERY_STAT(AimAssistObstacleCheck), false, GetOwner());
+		queryParams.AddIgnoredActor(CurrentTargetData.TargetComponent->GetOwner());
+		GetWorld()->LineTraceSingleByProfile(hitResult, GetCameraLocation(), socketLocation, ObstacleCheckProfileName, queryParams);
+
+		bLost = hitResult.bBlockingHit;
+	}
+
+	if (bLost)
+	{
+		LoseCurrentTarget();
+	}
+}
+
+void UUASAimAssistComponent::AddValidationTrace(TArray<FUASVisibilityTrace>& OutTraces, int32 ViewIndex)
+{
+	bTargetValidationRequested = false;
+
+	if (!CurrentTargetData.IsValid())
+	{
+		return;
+	}
+
+	auto& trace = OutTraces.AddDefaulted_GetRef();
+	trace.Start = GetCameraLocation();
+	trace.End = CurrentTargetData.GetSocketLocation();
+	trace.TargetData = CurrentTargetData;
+	trace.TargetActor = CurrentTargetData.TargetComponent->GetOwner();
+	trace.ViewIndex = ViewIndex;
+	trace.bValidation = true;
+}
+
+void UUASAimAssistComponent::ResolveValidationTrace(const FUASVisibilityTrace& Trace)
+{
+	// A given up trace keeps the target, a target changed while the trace was in flight was picked by a newer evaluation.
+	if (!Trace.bPending && !Trace.bVisible && Trace.TargetData == CurrentTargetData)
+	{
+		LoseCurrentTarget();
+	}
+}
+
+void UUASAimAssistComponent::LoseCurrentTarget()
+{
+	// Do not wait for the full scan rate, look for a new target in the next shared pass.
+	CurrentTargetData = {};
+	bTargetsRefreshRequested = true;
+	NextLODQueryTime = 0.0;
+}
+
+FVector UUASAimAssistComponent::GetOverlapExtents() const
+{
+	if (AimAssistDataAsset)
+	{
+		auto extents = AimAssistDataAsset->AimAreaExtents;
+		extents.X *= 0.5f;
+		return extents;
+	}
+
+	return FVector::ZeroVector;
+}
+
+FVector UUASAimAssistComponent::GetOverlapLocation() const
+{
+	FVector cameraLocation;
+	FRotator cameraRotation;
+
+	PlayerController->GetPlayerViewPoint(cameraLocation, cameraRotation);
+
+	return cameraLocation + cameraRotation.Vector() * AimAssistDataAsset->AimAreaExtents.X * 0.5f;
+}
+
+FRotator UUASAimAssistComponent::GetOverlapRotation() const
 {
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	if (AimAssistDataAsset == nullptr || !PlayerController.IsValid() || PlayerController->GetPawn() == nullptr)
-	{
-		return;
-	}
+	FVector viewLocation;
+	FRotator viewRotation;
 
-	HandleCurrentTarget();
-	UpdateCrosshair(DeltaTime);
-	UpdateZonesScaling(DeltaTime);
-	HandleAutoAim(DeltaTime);
+	PlayerController->GetPlayerViewPoint(viewLocation, viewRotation);
 
-#if !UE_BUILD_SHIPPING
-	DrawDebug(DeltaTime);
-#endif
+	return viewRotation;
 }
 
-FRotator UUASAimAssistComponent::GetRotationToCrosshairDirection(const FVector& From, FName TraceProfileName, float Distance) const
+FVector UUASAimAssistComponent::GetCameraLocation() const
 {
-	if (PlayerController.IsValid())
-	{
-		FVector worldOrigin;
-		FVector worldDirection;
+	FVector viewLocation;
+	FRotator viewRotation;
 
-		const auto crosshairPosition = (AimAssistDataAsset && CurrentTargetData.IsValid()) ? CrosshairPosition : GetScreenCenter();
-		
-		if (UGameplayStatics::DeprojectScreenToWorld(PlayerController.Get(), crosshairPosition, worldOrigin, worldDirection))
-		{
-			auto target = FVector::ZeroVector;
-			if (CurrentTargetData.IsValid() && bMagnetismAreaActive)
-			{
-				target = worldOrigin + worldDirection * (worldOrigin - CurrentTargetData.GetSocketLocation()).Size();
-			}
-			else
-			{
-				FHitResult hitResult;
+	PlayerController->GetPlayerViewPoint(viewLocation, viewRotation);
 
-				UKismetSystemLibrary::LineTraceSingleByProfile(this,
-				                                               worldOrigin,
-				                                               worldOrigin + worldDirection * Distance,
-				                                               TraceProfileName,
-				                                               false,
-				                                               { GetOwner() },
-				                                               EDrawDebugTrace::None,
-				                                               hitResult,
-				                                               true);
+	return viewLocation;
+}
 
-				target = hitResult.bBlockingHit ? hitResult.Location : FVector::ZeroVector;
-			}
+void UUASAimAssistComponent::RefreshViewState()
+{
+	const auto crosshairOffset = AimAssistDataAsset ? AimAssistDataAsset->CrosshairOffset : FVector2D::ZeroVector;
 
-			if (!target.IsZero())
-			{
-				return UKismetMathLibrary::FindLookAtRotation(From, target);
-			}
+	ViewState.ScreenCenter = crosshairOffset;
+	ViewState.DPIScale = 1.f;
+	ViewState.bScaledByDPI = bScalingByDPI;
+	ViewState.bValid = false;
 
-			return worldDirection.Rotation();
+	if (GEngine && GEngine->GameViewport)
+	{
+		FVector2D size;
+		GEngine->GameViewport->GetViewportSize(size);
+
+		ViewState.ScreenCenter += size * 0.5f;
+		ViewState.bValid = true;
+
+		if (bScalingByDPI)
+		{
+			ViewState.DPIScale = GEngine->GameViewport->GetDPIScale();
 		}
 	}
+	else if (bViewProjectionValid)
+	{
+		// Headless worlds have no game viewport, fall back to the view rect of the captured projection.
+		ViewState.ScreenCenter += FVector2D(ViewRect.Min.X + ViewRect.Width() * 0.5f, ViewRect.Min.Y + ViewRect.Height() * 0.5f);
+		ViewState.bValid = true;
+	}
 
-	return FRotator::ZeroRotator;
+	ViewState.StickinessRadius = AimAssistDataAsset ? AimAssistDataAsset->StickinessZoneConfig.Radius * ViewState.DPIScale : 0.f;
+	ViewState.MagnetismStartRadius = AimAssistDataAsset ? AimAssistDataAsset->MagnetismZoneConfig.StartRadius * ViewState.DPIScale : 0.f;
+	ViewState.MagnetismAimRadius = AimAssistDataAsset ? AimAssistDataAsset->MagnetismZoneConfig.AimZoneRadius * ViewState.DPIScale : 0.f;
+	ViewState.AutoAimRadius = AimAssistDataAsset ? AimAssistDataAsset->AutoAimConfig.AutoAimZoneRadius * ViewState.DPIScale : 0.f;
 }
 
-void UUASAimAssistComponent::SetAimAssistDataAsset(UUASAimAssistConfigDataAsset* DataAsset)
+void UUASAimAssistComponent::OnViewportResized(FViewport* Viewport, uint32 Unused)
 {
-	if (PlayerController.IsValid())
+	if (PlayerController.IsValid() && GetWorld() && GetWorld()->GetGameViewport() && GetWorld()->GetGameViewport()->Viewport == Viewport)
 	{
-		AimAssistDataAsset = DataAsset != nullptr ? DuplicateObject<UUASAimAssistConfigDataAsset>(DataAsset, this) : nullptr;
-		OnAimDataAssetChangedDelegate.Broadcast(AimAssistDataAsset);
-
-		GetWorld()->GetTimerManager().ClearTimer(UpdateTargetsTimerHandle);
-		
-		if (AimAssistDataAsset != nullptr)
-		{
-			GetWorld()->GetTimerManager().SetTimer(UpdateTargetsTimerHandle, FTimerDelegate::CreateUObject(this, &UUASAimAssistComponent::UpdateAssist), AimAssistDataAsset->UpdateTargetsRate, true);
-		}
-	
+		RefreshViewState();
+		CrosshairPositionDebug = GetScreenCenter();
 	}
 }
 
-void UUASAimAssistComponent::UpdateAssist()
+void UUASAimAssistComponent::OnWindowDPIScaleChanged(TSharedRef<SWindow> Window)
 {
-	if (AimAssistDataAsset == nullptr || !PlayerController.IsValid() || PlayerController->GetPawn() == nullptr)
+	if (PlayerController.IsValid())
 	{
-		return;
+		RefreshViewState();
 	}
-	
-	UpdateTargets();
-	HandleTargets();
 }
 
-bool UUASAimAssistComponent::CanUseAssist() const
+void UUASAimAssistComponent::UpdateViewProjection()
 {
-	if (PlayerController.IsValid() && PlayerController->IsLocalController()
-		&& ((PlayerController->GetLocalRole() == ENetRole::ROLE_AutonomousProxy && GetWorld()->GetNetMode() == NM_Client)
-		|| (PlayerController->GetLocalRole() == ENetRole::ROLE_Authority && GetWorld()->GetNetMode() != NM_Client && GetWorld()->GetNetMode() != NM_DedicatedServer))
-		)
+	if (ViewProjectionFrameNumber == GFrameCounter)
 	{
-		return true;
+		return;
 	}
 
-	return false;
-}
+	ViewProjectionFrameNumber = GFrameCounter;
+	bViewProjectionValid = false;
 
-void UUASAimAssistComponent::UpdateTargets()
-{
-	SCOPE_CYCLE_COUNTER(STAT_UpdateTargets);
+	const auto localPlayer = PlayerController.IsValid() ? PlayerController->GetLocalPlayer() : nullptr;
+
+	if (localPlayer == nullptr || localPlayer->ViewportClient == nullptr)
+	{
+		return;
+	}
 
-	TArray<FOverlapResult> overlapResults;
-	FCollisionQueryParams collisionParams;
-	collisionParams.AddIgnoredActor(PlayerController->GetPawn());
+	FSceneViewProjectionData projectionData;
 
-	GetWorld()->OverlapMultiByProfile(
-	    overlapResults,
-	    GetOverlapLocation(),
-	    GetOverlapRotation().Quaternion(),
-	    TargetsDetectionProfileName,
-	    FCollisionShape::MakeBox(GetOverlapExtents()),
-	    collisionParams);
+	if (localPlayer->GetProjectionData(localPlayer->ViewportClient->Viewport, projectionData))
+	{
+		ViewProjectionMatrix = projectionData.ComputeViewProjectionMatrix();
+		ViewRect = projectionData.GetConstrainedViewRect();
+		ProjectionScale = FMath::Max(projectionData.ProjectionMatrix.M[0][0] * ViewRect.Width(), projectionData.ProjectionMatrix.M[1][1] * ViewRect.Height()) * 0.5f;
+		bViewProjectionValid = true;
+	}
+}
 
-	TArray<TWeakObjectPtr<AActor>> targetsToRemove;
-	TargetComponents.GenerateKeyArray(targetsToRemove);
+FVector2D UUASAimAssistComponent::ProjectToScreen(const FVector& WorldLocation) const
+{
+	FVector2D location = FVector2D::ZeroVector;
 
-	for (const auto& result : overlapResults)
+	if (bViewProjectionValid)
 	{
-		if (TargetComponents.Contains(result.GetActor()))
-		{
-			targetsToRemove.Remove(result.GetActor());
-			continue;
-		}
+		FSceneView::ProjectWorldToScreen(WorldLocation, ViewRect, ViewProjectionMatrix, location);
+	}
 
-		TInlineComponentArray<UUASAimAssistTargetComponent*> targetComponents;
-		result.GetActor()->GetComponents(targetComponents);
+	return location;
+}
 
-		if (targetComponents.Num() != 0)
-		{
-			auto& val = TargetComponents.Add(TWeakObjectPtr<AActor>(result.GetActor()));
+float UUASAimAssistComponent::GetLargestScaledZoneRadius() const
+{
+	auto radius = 0.f;
 
-			result.GetActor()->OnDestroyed.AddDynamic(this, &UUASAimAssistComponent::OnTargetDestroyed);
+	if (IsStickinessEnabled())
+	{
+		radius = FMath::Max(radius, ViewState.StickinessRadius);
+	}
 
-			for (const auto component : targetComponents)
-			{
-				val.Add(component);
-			}
-		}
+	if (IsMagtetismEnabled())
+	{
+		radius = FMath::Max(radius, ViewState.MagnetismStartRadius);
 	}
 
-	for (const auto actor : targetsToRemove)
+	if (IsAutoAimEnabled())
 	{
-		actor->OnDestroyed.RemoveAll(this);
-		TargetComponents.Remove(actor);
+		radius = FMath::Max(radius, ViewState.AutoAimRadius);
 	}
-}
 
-void UUASAimAssistComponent::OnTargetDestroyed(AActor* DestroyedActor)
-{
-	TargetComponents.Remove(DestroyedActor);
+	// The current scale belongs to the current target only, any other target may be scaled up to the maximum of the curve.
+	return radius * (IsScalingEnabled() ? AimAssistDataAsset->MaxZonesScale : 1.f);
 }
 
-void UUASAimAssistComponent::HandleTargets()
+bool UUASAimAssistComponent::IsOutsideZones(const FSphere& Bounds, const FVector2D& ScreenCenter, float ZoneRadius) const
 {
-	SCOPE_CYCLE_COUNTER(STAT_HandleTargets);
-
-	LastTargetData.Empty(TargetComponents.Num());
+	if (!bViewProjectionValid || ZoneRadius <= 0.f)
+	{
+		return false;
+	}
 
-	const FVector viewLocation = GetCameraLocation();
+	const auto result = ViewProjectionMatrix.TransformFVector4(FVector4(Bounds.Center, 1.f));
 
-	for (const auto& target : TargetComponents)
+	// W is the view depth, a sphere reaching the camera plane cannot be bounded on screen.
+	if (result.W <= Bounds.W)
 	{
-		if (!target.Key.IsValid())
-		{
-			continue;
-		}
+		return result.W < -Bounds.W;
+	}
 
-		for (const auto component : target.Value)
-		{
-			if (!component.IsValid() || !component->IsTargetActive())
-			{
-				continue;
-			}
+	const auto rhw = 1.f / result.W;
+	const FVector2D location(ViewRect.Min.X + ViewRect.Width() * 0.5f * (1.f + result.X * rhw), ViewRect.Min.Y + ViewRect.Height() * 0.5f * (1.f - result.Y * rhw));
+	const auto projectedRadius = Bounds.W * ProjectionScale * rhw;
 
-			FHitResult hitResult;
+	return FVector2D::Distance(location, ScreenCenter) - projectedRadius > ZoneRadius;
+}
 
-			for (const auto& socketData : component->GetAimTargetSocketLocations())
-			{
-				UKismetSystemLibrary::LineTraceSingleByProfile(this,
-				                                               viewLocation,
-				                                               socketData.Location,
-				                                               ObstacleCheckProfileName,
-				                                               false,
-				                                               { GetOwner(), target.Key.Get() },
-				                                               bDebugTargetTraces ? EDrawDebugTrace::ForDuration : EDrawDebugTrace::None,
-				                                               hitResult,
-				                                               true);
+template <EUASAimAssistFeatures Features>
+void UUASAimAssistComponent::Evaluate(float DeltaTime)
+{
+	constexpr auto bZones = EnumHasAnyFlags(Features, EUASAimAssistFeatures::Stickiness | EUASAimAssistFeatures::Magnetism | EUASAimAssistFeatures::AutoAim);
 
-				if (hitResult.bBlockingHit)
-				{
-					continue;
-				}
+	if constexpr (bZones)
+	{
+		HandleCurrentTarget<Features>();
+	}
 
-				LastTargetData.Add({ component, socketData.SocketName });
-			}
-		}
+	UpdateCrosshair<Features>(DeltaTime);
+
+	if constexpr (EnumHasAnyFlags(Features, EUASAimAssistFeatures::Scaling))
+	{
+		UpdateZonesScaling(DeltaTime);
 	}
 
-	if (LastTargetData.Num() != 0)
+	if constexpr (EnumHasAnyFlags(Features, EUASAimAssistFeatures::AutoAim))
 	{
-		CurrentTargetData = *Algo::MinElementBy(LastTargetData, [&](const FUASAimAssistTargetData& Data) {
-			auto location = Data.GetLocationOnTheScreen(PlayerController.Get());
-			return (location - GetScreenCenter()).Size();
-		});
+		HandleAutoAim<Features>(DeltaTime);
 	}
 	else
 	{
-		CurrentTargetData = {};
+		LastRotationInput = FRotator::ZeroRotator;
 	}
 }
 
-FVector UUASAimAssistComponent::GetOverlapExtents() const
+void UUASAimAssistComponent::UpdatePipeline()
 {
-	if (AimAssistDataAsset)
+	static const FEvaluateFunction evaluateFunctions[] = {
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(0)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(1)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(2)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(3)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(4)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(5)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(6)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(7)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(8)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(9)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(10)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(11)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(12)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(13)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(14)>,
+		&UUASAimAssistComponent::Evaluate<static_cast<EUASAimAssistFeatures>(15)>,
+	};
+
+	static_assert(UE_ARRAY_COUNT(evaluateFunctions) == static_cast<uint8>(EUASAimAssistFeatures::All) + 1, "Every feature combination needs an instantiation.");
+
+	const auto features = GetRequestedFeatures();
+
+	// Areas of a feature that just got disabled would otherwise stay active, its stage no longer runs to clear them.
+	bStickinessAreaActive = false;
+	bMagnetismAreaActive = false;
+	bAutoAimAreaActive = false;
+
+	if (!EnumHasAnyFlags(features, EUASAimAssistFeatures::Scaling))
 	{
-		auto extents = AimAssistDataAsset->AimAreaExtents;
-		extents.X *= 0.5f;
-		return extents;
+		ZonesScaleMultiplier = 1.f;
 	}
 
-	return FVector::ZeroVector;
+	EnabledFeatures = features;
+	EvaluateFunction = evaluateFunctions[static_cast<uint8>(features)];
 }
 
-FVector UUASAimAssistComponent::GetOverlapLocation() const
+EUASAimAssistFeatures UUASAimAssistComponent::GetRequestedFeatures() const
 {
-	FVector cameraLocation;
-	FRotator cameraRotation;
+	auto features = EUASAimAssistFeatures::None;
 
-	PlayerController->GetPlayerViewPoint(cameraLocation, cameraRotation);
+	if (AimAssistDataAsset != nullptr)
+	{
+		if (bEnableStickiness && AimAssistDataAsset->bStickinessZoneConfig)
+		{
+			features |= EUASAimAssistFeatures::Stickiness;
+		}
 
-	return cameraLocation + cameraRotation.Vector() * AimAssistDataAsset->AimAreaExtents.X * 0.5f;
-}
+		if (bEnableMagnetism && AimAssistDataAsset->bMagnetismZoneConfig)
+		{
+			features |= EUASAimAssistFeatures::Magnetism;
+		}
 
-FRotator UUASAimAssistComponent::GetOverlapRotation() const
-{
-	FVector viewLocation;
-	FRotator viewRotation;
+		if (bEnableScaling && AimAssistDataAsset->bScalingZoneConfig)
+		{
+			features |= EUASAimAssistFeatures::Scaling;
+		}
 
-	PlayerController->GetPlayerViewPoint(viewLocation, viewRotation);
+		if (bEnableAutoAim && AimAssistDataAsset->bAutoAimConfig)
+		{
+			features |= EUASAimAssistFeatures::AutoAim;
+		}
+	}
 
-	return viewRotation;
+	return features;
 }
 
-FVector UUASAimAssistComponent::GetCameraLocation() const
+void UUASAimAssistComponent::SetEnableStickiness(bool bValue)
 {
-	FVector viewLocation;
-	FRotator viewRotation;
+	bEnableStickiness = bValue;
+	UpdatePipeline();
+}
 
-	PlayerController->GetPlayerViewPoint(viewLocation, viewRotation);
+void UUASAimAssistComponent::SetEnableMagnetism(bool bValue)
+{
+	bEnableMagnetism = bValue;
+	UpdatePipeline();
+}
 
-	return viewLocation;
+void UUASAimAssistComponent::SetEnableScaling(bool bValue)
+{
+	bEnableScaling = bValue;
+	UpdatePipeline();
 }
 
-FVector2D UUASAimAssistComponent::GetScreenCenter() const
+void UUASAimAssistComponent::SetEnableAutoAim(bool bValue)
 {
-	if (GEngine && GEngine->GameViewport)
-	{
-		FVector2D size;
-		GEngine->GameViewport->GetViewportSize(size);
+	bEnableAutoAim = bValue;
+	UpdatePipeline();
+}
 
-		return size * 0.5f + (AimAssistDataAsset ? AimAssistDataAsset->CrosshairOffset : FVector2D::ZeroVector);
-	}
+#if WITH_EDITOR
+void UUASAimAssistComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-	return {};
+	UpdatePipeline();
 }
+#endif
 
+template <EUASAimAssistFeatures Features>
 void UUASAimAssistComponent::HandleCurrentTarget()
 {
-	SCOPE_CYCLE_COUNTER(STAT_HandleCurrentTarget);
+	UAS_SCOPE_AIM_ASSIST_STAGE(HandleCurrentTarget);
 
 	bStickinessAreaActive = false;
 	bMagnetismAreaActive = false;
@@ -377,31 +1401,41 @@ void UUASAimAssistComponent::HandleCurrentTarget()
 		return;
 	}
 
-	const auto distance = (GetScreenCenter() - CurrentTargetData.GetLocationOnTheScreen(PlayerController.Get())).Size();
+	UpdateViewProjection();
+	CurrentTargetScreenLocation = ProjectToScreen(CurrentTargetData.GetSocketLocation());
+
+	const auto distance = (GetScreenCenter() - CurrentTargetScreenLocation).Size();
+
+	const auto zonesScale = EnumHasAnyFlags(Features, EUASAimAssistFeatures::Scaling) ? ZonesScaleMultiplier : 1.f;
 
-	const auto stickinessRadius = GetScaledZoneRadius(AimAssistDataAsset->StickinessZoneConfig.Radius);
-	if (distance <= stickinessRadius && IsStickinessEnabled())
+	const auto stickinessRadius = ViewState.StickinessRadius * zonesScale;
+	if (EnumHasAnyFlags(Features, EUASAimAssistFeatures::Stickiness) && distance <= stickinessRadius)
 	{
 		bStickinessAreaActive = true;
 	}
 
-	if (distance <= GetScaledZoneRadius(AimAssistDataAsset->MagnetismZoneConfig.StartRadius) && IsMagtetismEnabled())
+	if (EnumHasAnyFlags(Features, EUASAimAssistFeatures::Magnetism) && distance <= ViewState.MagnetismStartRadius * zonesScale)
 	{
 		bMagnetismAreaActive = true;
+
+		// Zones are entered by the current location, the pull itself goes to where the target is heading.
+		const auto leadTime = AimAssistDataAsset->MagnetismZoneConfig.LeadTime;
+		MagnetismTargetScreenLocation = leadTime > 0.f ? ProjectToScreen(CurrentTargetData.GetPredictedSocketLocation(leadTime)) : CurrentTargetScreenLocation;
 	}
 
-	if (distance <= GetScaledZoneRadius(AimAssistDataAsset->AutoAimConfig.AutoAimZoneRadius)
-	    && IsAutoAimEnabled() && (CurrentTargetData.GetSocketLocation() - PlayerController->GetPawn()->GetActorLocation()).Size() <= AimAssistDataAsset->AutoAimConfig.ActivationDistance)
+	if (EnumHasAnyFlags(Features, EUASAimAssistFeatures::AutoAim) && distance <= ViewState.AutoAimRadius * zonesScale
+	    && (CurrentTargetData.GetSocketLocation() - PlayerController->GetPawn()->GetActorLocation()).Size() <= AimAssistDataAsset->AutoAimConfig.ActivationDistance)
 	{
 		bAutoAimAreaActive = true;
 	}
 }
 
+template <EUASAimAssistFeatures Features>
 void UUASAimAssistComponent::HandleAutoAim(float DeltaTime)
 {
-	SCOPE_CYCLE_COUNTER(STAT_HandleAutoAim);
+	UAS_SCOPE_AIM_ASSIST_STAGE(HandleAutoAim);
 
-	if (!CurrentTargetData.IsValid() || PlayerController->GetPawn() == nullptr || !PlayerController.IsValid() || !bAutoAimAreaActive || !IsAutoAimEnabled())
+	if (!CurrentTargetData.IsValid() || PlayerController->GetPawn() == nullptr || !PlayerController.IsValid() || !bAutoAimAreaActive)
 	{
 		LastRotationInput = FRotator::ZeroRotator;
 		return;
@@ -448,10 +1482,10 @@ void UUASAimAssistComponent::HandleAutoAim(float DeltaTime)
 
 	if (TimeWithoutRotationInput >= AimAssistDataAsset->AutoAimConfig.TimeWithoutCameraInputToEnableAutoAim
 	    && TimeWithMovementInput >= AimAssistDataAsset->AutoAimConfig.TimeWithMovementInputToEnableAutoAim
-	    && (!AimAssistDataAsset->AutoAimConfig.bUseOnlyWithInactiveMagnetism || (!bMagnetismAreaActive || !IsMagtetismEnabled()))
+	    && (!AimAssistDataAsset->AutoAimConfig.bUseOnlyWithInactiveMagnetism || (!bMagnetismAreaActive || !EnumHasAnyFlags(Features, EUASAimAssistFeatures::Magnetism)))
 	    && !timerManager.IsTimerActive(WaitAfterChangeTargetToAutoAimTimerHandle))
 	{
-		const auto targetLocation = CurrentTargetData.GetSocketLocation();
+		const auto targetLocation = CurrentTargetData.GetPredictedSocketLocation(AimAssistDataAsset->AutoAimConfig.LeadTime);
 
 		auto targetRotation = UKismetMathLibrary::FindLookAtRotation(GetCameraLocation(), targetLocation);
 
@@ -464,6 +1498,7 @@ void UUASAimAssistComponent::HandleAutoAim(float DeltaTime)
 	}
 }
 
+template <EUASAimAssistFeatures Features>
 void UUASAimAssistComponent::UpdateCrosshair(float DeltaTime)
 {
 	if (!PlayerController.IsValid())
@@ -473,13 +1508,13 @@ void UUASAimAssistComponent::UpdateCrosshair(float DeltaTime)
 
 	FVector2D targetCrosshairPosition = GetScreenCenter();
 
-	if (IsMagtetismEnabled() && bMagnetismAreaActive && CurrentTargetData.IsValid())
+	if (EnumHasAnyFlags(Features, EUASAimAssistFeatures::Magnetism) && bMagnetismAreaActive && CurrentTargetData.IsValid())
 	{
-		const auto targetLocation = CurrentTargetData.GetLocationOnTheScreen(PlayerController.Get());
+		const auto targetLocation = MagnetismTargetScreenLocation;
 
 		const auto lenght = (targetLocation - targetCrosshairPosition).Size();
 
-		const auto magnetismRadius = GetScaledZoneRadius(AimAssistDataAsset->MagnetismZoneConfig.AimZoneRadius);
+		const auto magnetismRadius = ViewState.MagnetismAimRadius * (EnumHasAnyFlags(Features, EUASAimAssistFeatures::Scaling) ? ZonesScaleMultiplier : 1.f);
 
 		if (lenght > magnetismRadius)
 		{
@@ -497,7 +1532,7 @@ void UUASAimAssistComponent::UpdateCrosshair(float DeltaTime)
 
 void UUASAimAssistComponent::UpdateZonesScaling(float DeltaTime)
 {
-	if (!PlayerController.IsValid() || !IsScalingEnabled())
+	if (!PlayerController.IsValid())
 	{
 		return;
 	}
@@ -507,7 +1542,7 @@ void UUASAimAssistComponent::UpdateZonesScaling(float DeltaTime)
 	if (CurrentTargetData.IsValid())
 	{
 		const auto distanceToTarget = (CurrentTargetData.GetSocketLocation() - PlayerController->GetPawn()->GetActorLocation()).Size();
-		const auto curveValue = GetCurveValue(AimAssistDataAsset->ZonesScalingConfig.ZonesScalingCurve, distanceToTarget);
+		const auto curveValue = GetCurveValue(AimAssistDataAsset->ZonesScalingConfig.ZonesScalingCurve, AimAssistDataAsset->ZonesScalingLookupTable, distanceToTarget);
 		target = curveValue;
 	}
 
@@ -518,8 +1553,13 @@ void UUASAimAssistComponent::UpdateZonesScaling(float DeltaTime)
 #endif
 }
 
-float UUASAimAssistComponent::GetCurveValue(const FRuntimeFloatCurve& Curve, float Power) const
+float UUASAimAssistComponent::GetCurveValue(const FRuntimeFloatCurve& Curve, const FUASCurveLookupTable& LookupTable, float Power) const
 {
+	if (LookupTable.IsBaked())
+	{
+		return LookupTable.Eval(Power);
+	}
+
 	if (Curve.ExternalCurve != nullptr)
 	{
 		return Curve.ExternalCurve->GetFloatValue(Power);
@@ -532,23 +1572,6 @@ float UUASAimAssistComponent::GetCurveValue(const FRuntimeFloatCurve& Curve, flo
 	return 1.f;
 }
 
-float UUASAimAssistComponent::GetScaledZoneRadius(float From) const
-{
-	auto val = From;
-	
-	if (AimAssistDataAsset != nullptr)
-	{
-		val *= (IsScalingEnabled() ? ZonesScaleMultiplier : 1.f);
-	}
-
-	if (bScalingByDPI && GEngine && GEngine->GameViewport)
-	{
-		val *= GEngine->GameViewport->GetDPIScale();
-	}
-	
-	return val;
-}
-
 void UUASAimAssistComponent::GetControlMultipliers(float& Pitch, float& Yaw) const
 {
 	if (!CurrentTargetData.IsValid() || !PlayerController.IsValid() || !IsStickinessEnabled() || !bStickinessAreaActive)
@@ -558,14 +1581,14 @@ void UUASAimAssistComponent::GetControlMultipliers(float& Pitch, float& Yaw) con
 		return;
 	}
 
-	const auto distance = (GetScreenCenter() - CurrentTargetData.GetLocationOnTheScreen(PlayerController.Get())).Size();
+	const auto distance = (GetScreenCenter() - CurrentTargetScreenLocation).Size();
 
-	const auto stickinessRadius = GetScaledZoneRadius(AimAssistDataAsset->StickinessZoneConfig.Radius);
+	const auto stickinessRadius = ViewState.StickinessRadius * GetZonesScaleMultiplier();
 
 	const auto power = 1.f - distance / stickinessRadius;
 
-	auto multiplierPitch = GetCurveValue(AimAssistDataAsset->StickinessZoneConfig.StickinessMultiplierCurvePitch, power);
-	auto multiplierYaw = GetCurveValue(AimAssistDataAsset->StickinessZoneConfig.StickinessMultiplierCurveYaw, power);
+	auto multiplierPitch = GetCurveValue(AimAssistDataAsset->StickinessZoneConfig.StickinessMultiplierCurvePitch, AimAssistDataAsset->StickinessPitchLookupTable, power);
+	auto multiplierYaw = GetCurveValue(AimAssistDataAsset->StickinessZoneConfig.StickinessMultiplierCurveYaw, AimAssistDataAsset->StickinessYawLookupTable, power);
 
 	multiplierPitch *= AimAssistDataAsset->StickinessZoneConfig.Multiplier;
 	multiplierYaw *= AimAssistDataAsset->StickinessZoneConfig.Multiplier;
@@ -574,46 +1597,6 @@ void UUASAimAssistComponent::GetControlMultipliers(float& Pitch, float& Yaw) con
 	Yaw = multiplierYaw;
 }
 
-bool UUASAimAssistComponent::IsMagtetismEnabled() const
-{
-	if (AimAssistDataAsset != nullptr)
-	{
-		return bEnableMagnetism && AimAssistDataAsset->bMagnetismZoneConfig;
-	}
-
-	return false;
-}
-
-bool UUASAimAssistComponent::IsStickinessEnabled() const
-{
-	if (AimAssistDataAsset != nullptr)
-	{
-		return bEnableStickiness && AimAssistDataAsset->bStickinessZoneConfig;
-	}
-
-	return false;
-}
-
-bool UUASAimAssistComponent::IsScalingEnabled() const
-{
-	if (AimAssistDataAsset != nullptr)
-	{
-		return bEnableScaling && AimAssistDataAsset->bScalingZoneConfig;
-	}
-
-	return false;
-}
-
-bool UUASAimAssistComponent::IsAutoAimEnabled() const
-{
-	if (AimAssistDataAsset != nullptr)
-	{
-		return bEnableAutoAim && AimAssistDataAsset->bAutoAimConfig;
-	}
-
-	return false;
-}
-
 #if !UE_BUILD_SHIPPING
 float UUASAimAssistComponent::GetScaledZoneRadiusForDebug(float From) const
 {
@@ -624,12 +1607,7 @@ float UUASAimAssistComponent::GetScaledZoneRadiusForDebug(float From) const
 		 val *= (IsScalingEnabled() ? ZonesScaleMultiplierDebug : 1.f);
 	}
 
-	if (bScalingByDPI && GEngine && GEngine->GameViewport)
-	{
-		val *= GEngine->GameViewport->GetDPIScale();
-	}
-	
-	return val;
+	return val * ViewState.DPIScale;
 }
 
 void UUASAimAssistComponent::DrawHudDebug(AHUD* HUD, UCanvas* Canvas) const
@@ -1,3 +1,99 @@
 ﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
 
 #include "UASAimAssistConfigDataAsset.h"
+
+void FUASCurveLookupTable::Bake(const FRuntimeFloatCurve& Curve, int32 NumSamples)
+{
+	Samples.Reset();
+
+	const auto richCurve = Curve.ExternalCurve != nullptr ? &Curve.ExternalCurve->FloatCurve : Curve.GetRichCurveConst();
+
+	if (richCurve == nullptr || richCurve->GetNumKeys() == 0)
+	{
+		return;
+	}
+
+	float maxTime = 0.f;
+	richCurve->GetTimeRange(MinTime, maxTime);
+
+	NumSamples = FMath::Max(NumSamples, 2);
+	const auto step = (maxTime - MinTime) / (NumSamples - 1);
+	InvStep = step > KINDA_SMALL_NUMBER ? 1.f / step : 0.f;
+
+	Samples.SetNumUninitialized(NumSamples);
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Samples[i] = richCurve->Eval(MinTime + step * i);
+	}
+}
+
+float FUASCurveLookupTable::Eval(float Time) const
+{
+	const auto position = FMath::Clamp((Time - MinTime) * InvStep, 0.f, static_cast<float>(Samples.Num() - 1));
+	const auto index = FMath::Min(FMath::FloorToInt(position), Samples.Num() - 2);
+
+	return FMath::Lerp(Samples[index], Samples[index + 1], position - index);
+}
+
+UUASAimAssistConfigDataAsset::UUASAimAssistConfigDataAsset()
+{
+	TargetLODIntervalCurve.GetRichCurve()->AddKey(0.f, 0.5f);
+	TargetLODIntervalCurve.GetRichCurve()->AddKey(1.f, 0.f);
+
+	TargetLODSocketsCurve.GetRichCurve()->AddKey(0.f, 0.f);
+	TargetLODSocketsCurve.GetRichCurve()->AddKey(1.f, 1.f);
+}
+
+void UUASAimAssistConfigDataAsset::BakeCurves()
+{
+	MaxZonesScale = 1.f;
+
+	const auto& zonesScalingCurve = ZonesScalingConfig.ZonesScalingCurve;
+	const auto zonesScalingRichCurve = zonesScalingCurve.ExternalCurve != nullptr ? &zonesScalingCurve.ExternalCurve->FloatCurve : zonesScalingCurve.GetRichCurveConst();
+
+	if (zonesScalingRichCurve != nullptr && zonesScalingRichCurve->GetNumKeys() != 0)
+	{
+		float minValue = 0.f;
+		float maxValue = 0.f;
+		zonesScalingRichCurve->GetValueRange(minValue, maxValue);
+		MaxZonesScale = FMath::Max(MaxZonesScale, maxValue);
+
+		// Cubic keys can overshoot their values between two keys, the dense sampling catches most of it.
+		float minTime = 0.f;
+		float maxTime = 0.f;
+		zonesScalingRichCurve->GetTimeRange(minTime, maxTime);
+
+		const auto numSamples = FMath::Max(CurveLookupTableSize, 2) * 4;
+
+		for (int32 i = 0; i < numSamples; ++i)
+		{
+			MaxZonesScale = FMath::Max(MaxZonesScale, zonesScalingRichCurve->Eval(FMath::Lerp(minTime, maxTime, static_cast<float>(i) / (numSamples - 1))));
+		}
+	}
+
+	if (bExactCurveEvaluation)
+	{
+		StickinessPitchLookupTable.Reset();
+		StickinessYawLookupTable.Reset();
+		ZonesScalingLookupTable.Reset();
+		TargetLODIntervalLookupTable.Reset();
+		TargetLODSocketsLookupTable.Reset();
+		return;
+	}
+
+	StickinessPitchLookupTable.Bake(StickinessZoneConfig.StickinessMultiplierCurvePitch, CurveLookupTableSize);
+	StickinessYawLookupTable.Bake(StickinessZoneConfig.StickinessMultiplierCurveYaw, CurveLookupTableSize);
+	ZonesScalingLookupTable.Bake(ZonesScalingConfig.ZonesScalingCurve, CurveLookupTableSize);
+	TargetLODIntervalLookupTable.Bake(TargetLODIntervalCurve, CurveLookupTableSize);
+	TargetLODSocketsLookupTable.Bake(TargetLODSocketsCurve, CurveLookupTableSize);
+}
+
+#if WITH_EDITOR
+void UUASAimAssistConfigDataAsset::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BakeCurves();
+}
+#endif
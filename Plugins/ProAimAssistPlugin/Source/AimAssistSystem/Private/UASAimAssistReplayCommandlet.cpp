@@ -0,0 +1,249 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistReplayCommandlet.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/DefaultPawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UASAimAssistComponent.h"
+#include "UASAimAssistConfigDataAsset.h"
+#include "UASAimAssistTargetComponent.h"
+#include "UASAimAssistTargetSubsystem.h"
+#include "UASAimAssistTelemetry.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimAssistReplay, Log, All);
+
+UUASAimAssistReplayCommandlet::UUASAimAssistReplayCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UUASAimAssistReplayCommandlet::Main(const FString& Params)
+{
+	FString recordingPath;
+	FString configPath;
+
+	if (!FParse::Value(*Params, TEXT("Recording="), recordingPath))
+	{
+		UE_LOG(LogAimAssistReplay, Error, TEXT("Pass the telemetry file with -Recording=<file>."));
+		return 1;
+	}
+
+	FString outputPath = FPaths::ProjectSavedDir() / TEXT("AimAssistReplay") / FPaths::GetBaseFilename(recordingPath);
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	TArray<FUASAimAssistTelemetryFrame> frames;
+
+	if (!FUASAimAssistTelemetryRecorder::Load(recordingPath, frames) || frames.Num() == 0)
+	{
+		return 1;
+	}
+
+	UUASAimAssistConfigDataAsset* config = nullptr;
+
+	if (FParse::Value(*Params, TEXT("Config="), configPath))
+	{
+		config = LoadObject<UUASAimAssistConfigDataAsset>(nullptr, *configPath);
+
+		if (config == nullptr)
+		{
+			UE_LOG(LogAimAssistReplay, Error, TEXT("Failed to load aim assist config %s."), *configPath);
+			return 1;
+		}
+	}
+	else
+	{
+		config = NewObject<UUASAimAssistConfigDataAsset>();
+	}
+
+	TArray<FFrameResult> results;
+
+	if (!Replay(frames, config, results))
+	{
+		return 1;
+	}
+
+	auto numTargetChanges = 0;
+	auto numZoneChanges = 0;
+	auto maxMultiplierDelta = 0.f;
+	auto maxCrosshairDelta = 0.f;
+	auto totalUs = 0.0;
+
+	for (const auto& result : results)
+	{
+		numTargetChanges += result.RecordedTarget != result.ReplayedTarget ? 1 : 0;
+		numZoneChanges += result.RecordedZones != result.ReplayedZones ? 1 : 0;
+		maxMultiplierDelta = FMath::Max3(maxMultiplierDelta, result.PitchMultiplierDelta, result.YawMultiplierDelta);
+		maxCrosshairDelta = FMath::Max(maxCrosshairDelta, result.CrosshairDelta);
+		totalUs += result.EvaluateUs;
+	}
+
+	UE_LOG(LogAimAssistReplay, Display, TEXT("%d frames, mean %.2fus, %d target differences, %d zone differences, max multiplier delta %.3f, max crosshair delta %.1fpx"),
+	       results.Num(), totalUs / results.Num(), numTargetChanges, numZoneChanges, maxMultiplierDelta, maxCrosshairDelta);
+
+	return WriteReport(outputPath, frames, results) ? 0 : 1;
+}
+
+bool UUASAimAssistReplayCommandlet::Replay(const TArray<FUASAimAssistTelemetryFrame>& Frames, UUASAimAssistConfigDataAsset* Config, TArray<FFrameResult>& OutResults)
+{
+	auto world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("AimAssistReplay"));
+	auto& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(world);
+
+	world->InitializeActorsForPlay(FURL());
+	world->GetWorldSettings()->NotifyBeginPlay();
+
+	auto subsystem = world->GetSubsystem<UUASAimAssistTargetSubsystem>();
+
+	// One single socket target per recorded candidate id, so a target keeps its identity while the candidate order changes.
+	TMap<uint64, int32> targetsById;
+
+	for (const auto& frame : Frames)
+	{
+		for (const auto id : frame.CandidateIds)
+		{
+			if (!targetsById.Contains(id))
+			{
+				targetsById.Add(id, targetsById.Num());
+			}
+		}
+	}
+
+	TArray<UUASAimAssistTargetComponent*> targets;
+
+	for (int32 i = 0; i < targetsById.Num(); ++i)
+	{
+		auto actor = world->SpawnActor<AActor>();
+		auto mesh = NewObject<UStaticMeshComponent>(actor);
+		actor->SetRootComponent(mesh);
+		mesh->RegisterComponent();
+
+		auto target = NewObject<UUASAimAssistTargetComponent>(actor);
+		target->AimTargetSocketNames.Add(TEXT("Socket"));
+		target->RegisterComponent();
+		target->Init(mesh);
+
+		targets.Add(target);
+	}
+
+	auto controller = world->SpawnActor<APlayerController>();
+	auto pawn = world->SpawnActor<ADefaultPawn>();
+	controller->Possess(pawn);
+
+	auto aimAssist = NewObject<UUASAimAssistComponent>(controller);
+	aimAssist->AimAssistDataAsset = Config;
+	aimAssist->RegisterComponent();
+
+	// There is no local player in a commandlet, wire the view up by hand.
+	aimAssist->PlayerController = controller;
+	aimAssist->SetAimAssistDataAsset(Config);
+	subsystem->RegisterView(aimAssist);
+
+	// Nothing ticks the async trace queue here, obstacle checks have to complete inside the frame.
+	aimAssist->AimAssistDataAsset->bAsyncObstacleChecks = false;
+
+	const auto startTime = Frames[0].Time;
+
+	for (const auto& frame : Frames)
+	{
+		++GFrameCounter;
+		world->TimeSeconds = frame.Time - startTime;
+
+		// Targets the frame did not see are switched off.
+		for (const auto target : targets)
+		{
+			target->SetAimAssistTargetActive(false);
+		}
+
+		for (int32 i = 0; i < frame.CandidateIds.Num(); ++i)
+		{
+			const auto target = targets[targetsById[frame.CandidateIds[i]]];
+			target->SetAimAssistTargetActive(true);
+			target->GetMesh()->SetWorldLocation(frame.CandidateLocations[i]);
+		}
+
+		// The pawn eye offset is unknown to the recording, place the pawn so the view point lands on the recorded camera.
+		controller->SetControlRotation(frame.ControlRotation);
+		pawn->SetActorLocation(frame.CameraLocation);
+
+		FVector viewLocation;
+		FRotator viewRotation;
+		controller->GetPlayerViewPoint(viewLocation, viewRotation);
+		pawn->SetActorLocation(frame.CameraLocation * 2.f - viewLocation);
+
+		const auto viewMatrix = FTranslationMatrix(-frame.CameraLocation) * FInverseRotationMatrix(frame.CameraRotation) * FMatrix(FPlane(0, 0, 1, 0), FPlane(1, 0, 0, 0), FPlane(0, 1, 0, 0), FPlane(0, 0, 0, 1));
+		const auto projectionMatrix = viewMatrix.Inverse() * frame.ViewProjectionMatrix;
+
+		aimAssist->ViewProjectionMatrix = frame.ViewProjectionMatrix;
+		aimAssist->ViewRect = frame.ViewRect;
+		aimAssist->ProjectionScale = FMath::Max(projectionMatrix.M[0][0] * frame.ViewRect.Width(), projectionMatrix.M[1][1] * frame.ViewRect.Height()) * 0.5f;
+		aimAssist->bViewProjectionValid = true;
+		aimAssist->ViewProjectionFrameNumber = GFrameCounter;
+		aimAssist->RefreshViewState();
+
+		const auto start = FPlatformTime::Seconds();
+
+		// Targets are refreshed on the frames the recording refreshed them, requests of the replayed schedule itself are dropped.
+		if (frame.bTargetsRefreshed)
+		{
+			aimAssist->UpdateAssist();
+		}
+
+		subsystem->Tick(frame.DeltaTime);
+		aimAssist->TickComponent(frame.DeltaTime, LEVELTICK_All, &aimAssist->PrimaryComponentTick);
+		aimAssist->bTargetsRefreshRequested = false;
+
+		auto& result = OutResults.AddDefaulted_GetRef();
+		result.EvaluateUs = (FPlatformTime::Seconds() - start) * 1000000.0;
+		result.RecordedTarget = frame.CandidateIds.IsValidIndex(frame.CurrentCandidate) ? targetsById[frame.CandidateIds[frame.CurrentCandidate]] : INDEX_NONE;
+		result.ReplayedTarget = targets.IndexOfByKey(aimAssist->CurrentTargetData.TargetComponent.Get());
+		result.RecordedZones = frame.ActiveZones;
+		result.ReplayedZones = static_cast<uint8>((aimAssist->bStickinessAreaActive ? EUASAimAssistFeatures::Stickiness : EUASAimAssistFeatures::None)
+		                                          | (aimAssist->bMagnetismAreaActive ? EUASAimAssistFeatures::Magnetism : EUASAimAssistFeatures::None)
+		                                          | (aimAssist->bAutoAimAreaActive ? EUASAimAssistFeatures::AutoAim : EUASAimAssistFeatures::None));
+
+		float pitch = 1.f;
+		float yaw = 1.f;
+		aimAssist->GetControlMultipliers(pitch, yaw);
+
+		result.PitchMultiplierDelta = FMath::Abs(pitch - frame.PitchMultiplier);
+		result.YawMultiplierDelta = FMath::Abs(yaw - frame.YawMultiplier);
+		result.CrosshairDelta = FVector2D::Distance(aimAssist->CrosshairPosition, frame.CrosshairPosition);
+	}
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+
+	return true;
+}
+
+bool UUASAimAssistReplayCommandlet::WriteReport(const FString& OutputPath, const TArray<FUASAimAssistTelemetryFrame>& Frames, const TArray<FFrameResult>& Results)
+{
+	FString csv = TEXT("Frame,Time,EvaluateUs,RecordedTarget,ReplayedTarget,RecordedZones,ReplayedZones,PitchMultiplierDelta,YawMultiplierDelta,CrosshairDelta\n");
+
+	for (int32 i = 0; i < Results.Num(); ++i)
+	{
+		const auto& result = Results[i];
+
+		csv += FString::Printf(TEXT("%d,%.4f,%.3f,%d,%d,%d,%d,%.4f,%.4f,%.2f\n"),
+		                       i, Frames[i].Time - Frames[0].Time, result.EvaluateUs, result.RecordedTarget, result.ReplayedTarget,
+		                       result.RecordedZones, result.ReplayedZones, result.PitchMultiplierDelta, result.YawMultiplierDelta, result.CrosshairDelta);
+	}
+
+	const auto bWritten = FFileHelper::SaveStringToFile(csv, *(OutputPath + TEXT(".csv")));
+
+	if (!bWritten)
+	{
+		UE_LOG(LogAimAssistReplay, Error, TEXT("Failed to write replay report to %s"), *OutputPath);
+	}
+
+	return bWritten;
+}
@@ -0,0 +1,35 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistStageTimings.h"
+
+#if !UE_BUILD_SHIPPING
+bool FUASAimAssistStageTimings::bEnabled = false;
+double FUASAimAssistStageTimings::Seconds[static_cast<int32>(EUASAimAssistStage::Num)] = {};
+
+void FUASAimAssistStageTimings::Reset()
+{
+	for (auto& seconds : Seconds)
+	{
+		seconds = 0.0;
+	}
+}
+
+const TCHAR* FUASAimAssistStageTimings::GetStageName(EUASAimAssistStage Stage)
+{
+	switch (Stage)
+	{
+		case EUASAimAssistStage::UpdateTargets:
+			return TEXT("UpdateTargets");
+		case EUASAimAssistStage::HandleTargets:
+			return TEXT("HandleTargets");
+		case EUASAimAssistStage::TraceVisibility:
+			return TEXT("TraceVisibility");
+		case EUASAimAssistStage::HandleCurrentTarget:
+			return TEXT("HandleCurrentTarget");
+		case EUASAimAssistStage::HandleAutoAim:
+			return TEXT("HandleAutoAim");
+		default:
+			return TEXT("Unknown");
+	}
+}
+#endif
@@ -3,6 +3,14 @@
 #include "UASAimAssistTargetComponent.h"
 
 #include "Components/MeshComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "Engine/World.h"
+#include "UASAimAssistTargetSubsystem.h"
+
+/** Samples older than this do not contribute to the velocity, a target seen again after a while starts from rest. */
+static constexpr double VelocityHistoryWindow = 0.25;
 
 UUASAimAssistTargetComponent::UUASAimAssistTargetComponent()
 {
@@ -12,26 +20,198 @@ UUASAimAssistTargetComponent::UUASAimAssistTargetComponent()
 void UUASAimAssistTargetComponent::BeginPlay()
 {
 	Super::BeginPlay();
+
+	if (auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>())
+	{
+		subsystem->RegisterTarget(this);
+	}
+}
+
+void UUASAimAssistTargetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (auto subsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>())
+	{
+		subsystem->UnregisterTarget(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UUASAimAssistTargetComponent::Init(UMeshComponent* Mesh)
 {
 	MeshComponent = Mesh;
+	SkinnedMeshComponent = Cast<USkinnedMeshComponent>(MeshComponent);
+	ResolveSockets();
+}
+
+void UUASAimAssistTargetComponent::GetAimTargetSocketLocations(TArray<FUASSocketData>& OutLocations) const
+{
+	OutLocations.Reset();
+
+	if (IsTargetActive() && IsSocketCacheValid())
+	{
+		OutLocations.Append(CachedSockets);
+	}
+}
+
+FVector UUASAimAssistTargetComponent::GetAimTargetSocketLocation(int32 SocketIndex) const
+{
+	if (MeshComponent == nullptr || !IsSocketCacheValid())
+	{
+		return FVector::ZeroVector;
+	}
+
+	return CachedSockets.IsValidIndex(SocketIndex) ? CachedSockets[SocketIndex].Location : FVector::ZeroVector;
+}
+
+FVector UUASAimAssistTargetComponent::GetAimTargetSocketVelocity(int32 SocketIndex) const
+{
+	if (MeshComponent == nullptr || !IsSocketCacheValid())
+	{
+		return FVector::ZeroVector;
+	}
+
+	if (!CachedSockets.IsValidIndex(SocketIndex))
+	{
+		return FVector::ZeroVector;
+	}
+
+	const auto now = HistoryTimes[HistoryHead];
+	auto oldest = HistoryHead;
+
+	for (int32 i = 1; i < NumHistorySamples; ++i)
+	{
+		const auto sample = (HistoryHead - i + VelocityHistorySize) % VelocityHistorySize;
+
+		if (now - HistoryTimes[sample] > VelocityHistoryWindow)
+		{
+			break;
+		}
+
+		oldest = sample;
+	}
+
+	const auto deltaTime = now - HistoryTimes[oldest];
+
+	if (oldest == HistoryHead || deltaTime <= SMALL_NUMBER)
+	{
+		return FVector::ZeroVector;
+	}
+
+	const auto numSockets = CachedSockets.Num();
+	return (LocationHistory[HistoryHead * numSockets + SocketIndex] - LocationHistory[oldest * numSockets + SocketIndex]) / deltaTime;
+}
+
+void UUASAimAssistTargetComponent::ResolveSockets() const
+{
+	ResolvedSocketNames = AimTargetSocketNames;
+	ResolvedMeshAsset = GetMeshAsset();
+	ResolvedSockets.Reset(AimTargetSocketNames.Num());
+	CachedSockets.Reset(AimTargetSocketNames.Num());
+	CachedSocketsFrameNumber = MAX_uint64;
+	LocationHistory.SetNumZeroed(AimTargetSocketNames.Num() * VelocityHistorySize);
+	HistoryHead = 0;
+	NumHistorySamples = 0;
+
+	if (MeshComponent == nullptr)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < AimTargetSocketNames.Num(); ++i)
+	{
+		const auto socketName = AimTargetSocketNames[i];
+		auto& resolved = ResolvedSockets.AddDefaulted_GetRef();
+
+		CachedSockets.Add({ socketName, i, FVector::ZeroVector });
+
+		if (SkinnedMeshComponent != nullptr)
+		{
+			auto boneName = socketName;
+
+			if (const auto socket = SkinnedMeshComponent->GetSocketByName(socketName))
+			{
+				boneName = socket->BoneName;
+				resolved.LocalTransform = socket->GetSocketLocalTransform();
+			}
+
+			resolved.BoneIndex = SkinnedMeshComponent->GetBoneIndex(boneName);
+
+			if (resolved.BoneIndex != INDEX_NONE)
+			{
+				continue;
+			}
+		}
+
+		// Sockets that are not driven by a bone never move relative to the component.
+		resolved.LocalTransform = MeshComponent->GetSocketTransform(socketName, RTS_Component);
+	}
+}
+
+bool UUASAimAssistTargetComponent::AreSocketsResolved() const
+{
+	return ResolvedMeshAsset.Get() == GetMeshAsset() && ResolvedSocketNames == AimTargetSocketNames;
+}
+
+const UObject* UUASAimAssistTargetComponent::GetMeshAsset() const
+{
+	if (SkinnedMeshComponent != nullptr)
+	{
+		return SkinnedMeshComponent->SkeletalMesh;
+	}
+
+	if (const auto staticMeshComponent = Cast<UStaticMeshComponent>(MeshComponent))
+	{
+		return staticMeshComponent->GetStaticMesh();
+	}
+
+	return nullptr;
 }
 
-TArray<FUASSocketData> UUASAimAssistTargetComponent::GetAimTargetSocketLocations() const
+void UUASAimAssistTargetComponent::RefreshSocketCache() const
 {
-	TArray<FUASSocketData> locations;
+	if (CachedSocketsFrameNumber == GFrameCounter || MeshComponent == nullptr)
+	{
+		return;
+	}
+
+	// The socket list is editable from Blueprint and the mesh asset can be swapped at runtime, either leaves the bone indices stale.
+	if (!AreSocketsResolved())
+	{
+		ResolveSockets();
+	}
 
-	if (IsTargetActive())
+	CachedSocketsFrameNumber = GFrameCounter;
+
+	const auto& componentTransform = MeshComponent->GetComponentTransform();
+
+	for (int32 i = 0; i < ResolvedSockets.Num(); ++i)
 	{
-		for (auto& socket : AimTargetSocketNames)
+		const auto& resolved = ResolvedSockets[i];
+
+		if (resolved.BoneIndex != INDEX_NONE)
 		{
-			locations.Add({ socket, MeshComponent->GetSocketLocation(socket) });
+			const auto boneTransform = SkinnedMeshComponent->GetBoneTransform(resolved.BoneIndex, componentTransform);
+			CachedSockets[i].Location = boneTransform.TransformPosition(resolved.LocalTransform.GetLocation());
+		}
+		else
+		{
+			CachedSockets[i].Location = componentTransform.TransformPosition(resolved.LocalTransform.GetLocation());
 		}
 	}
 
-	return locations;
+	if (NumHistorySamples != 0)
+	{
+		HistoryHead = (HistoryHead + 1) % VelocityHistorySize;
+	}
+
+	NumHistorySamples = FMath::Min(NumHistorySamples + 1, VelocityHistorySize);
+	HistoryTimes[HistoryHead] = GetWorld()->GetTimeSeconds();
+
+	for (int32 i = 0; i < CachedSockets.Num(); ++i)
+	{
+		LocationHistory[HistoryHead * CachedSockets.Num() + i] = CachedSockets[i].Location;
+	}
 }
 
 bool UUASAimAssistTargetComponent::IsTargetActive() const
@@ -0,0 +1,576 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistTargetSubsystem.h"
+
+#include "Components/MeshComponent.h"
+#include "DrawDebugHelpers.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UASAimAssistConfigDataAsset.h"
+#include "UASAimAssistStageTimings.h"
+#include "UASAimAssistTargetComponent.h"
+
+static TAutoConsoleVariable<float> CVarAimAssistTargetGridCellSize(
+	TEXT("AimAssist.TargetGridCellSize"),
+	1000.f,
+	TEXT("Cell size in world units of the grid used to gather aim assist targets."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAimAssistMaxPendingTraceFrames(
+	TEXT("AimAssist.MaxPendingTraceFrames"),
+	10,
+	TEXT("Frames an async obstacle check batch may stay incomplete before its missing traces are given up."),
+	ECVF_Default);
+
+void UUASAimAssistTargetSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	RefreshTargetSockets();
+
+	// A trace whose delegate never fires, dropped on a travel or a world teardown, would otherwise hold up every later refresh.
+	if (NumPendingVisibilityTraces != 0 && GFrameCounter - VisibilityBatchFrame > static_cast<uint64>(FMath::Max(CVarAimAssistMaxPendingTraceFrames.GetValueOnGameThread(), 1)))
+	{
+		NumPendingVisibilityTraces = 0;
+		ResolveVisibility();
+	}
+
+	// An async batch still in flight keeps the remaining requests queued for the next frame.
+	if (NumPendingVisibilityTraces == 0)
+	{
+		RefreshViews();
+	}
+
+	for (const auto view : Views)
+	{
+		if (view != nullptr && view->IsTimeSlicedUpdatePending() && view->CanUpdateTargets())
+		{
+			view->ProcessTimeSlice();
+		}
+	}
+}
+
+TStatId UUASAimAssistTargetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUASAimAssistTargetSubsystem, STATGROUP_Tickables);
+}
+
+void UUASAimAssistTargetSubsystem::RegisterTarget(UUASAimAssistTargetComponent* Target)
+{
+	if (Target != nullptr && Target->RegistryIndex == INDEX_NONE)
+	{
+		Target->RegistryIndex = Targets.Add(Target);
+		TargetEntries.AddDefaulted();
+		GridFrameNumber = MAX_uint64;
+		++TargetsGeneration;
+	}
+}
+
+void UUASAimAssistTargetSubsystem::UnregisterTarget(UUASAimAssistTargetComponent* Target)
+{
+	if (Target == nullptr || !Targets.IsValidIndex(Target->RegistryIndex) || Targets[Target->RegistryIndex] != Target)
+	{
+		return;
+	}
+
+	RemoveTargetAt(Target->RegistryIndex);
+	Target->RegistryIndex = INDEX_NONE;
+}
+
+void UUASAimAssistTargetSubsystem::RemoveTargetAt(int32 TargetIndex)
+{
+	const auto lastIndex = Targets.Num() - 1;
+
+	RemoveFromGrid(TargetIndex);
+
+	// The last target moves into the freed slot, its cells are keyed by its index so it is taken out of the grid and put back.
+	const auto bMoved = TargetIndex != lastIndex && TargetEntries[lastIndex].bInGrid;
+
+	if (bMoved)
+	{
+		RemoveFromGrid(lastIndex);
+	}
+
+	Targets.RemoveAtSwap(TargetIndex, 1, false);
+	TargetEntries.RemoveAtSwap(TargetIndex, 1, false);
+
+	if (Targets.IsValidIndex(TargetIndex) && Targets[TargetIndex] != nullptr)
+	{
+		Targets[TargetIndex]->RegistryIndex = TargetIndex;
+	}
+
+	if (bMoved)
+	{
+		AddToGrid(TargetIndex);
+	}
+
+	++TargetsGeneration;
+}
+
+void UUASAimAssistTargetSubsystem::RegisterView(UUASAimAssistComponent* View)
+{
+	if (View != nullptr)
+	{
+		Views.AddUnique(View);
+	}
+}
+
+void UUASAimAssistTargetSubsystem::UnregisterView(UUASAimAssistComponent* View)
+{
+	Views.RemoveSingleSwap(View, false);
+}
+
+void UUASAimAssistTargetSubsystem::RefreshTargetSockets()
+{
+	for (const auto target : Targets)
+	{
+		if (target != nullptr && target->IsTargetActive())
+		{
+			target->RefreshSocketCache();
+		}
+	}
+}
+
+void UUASAimAssistTargetSubsystem::RefreshViews()
+{
+	PassViews.Reset();
+	PassViewsRefreshed.Reset();
+	VisibilityTraces.Reset();
+
+	// Rows of a finished time sliced cycle are final, so their traces can be batched before any view starts a new cycle.
+	for (const auto view : Views)
+	{
+		if (view == nullptr || !view->bTimeSlicedTracesRequested)
+		{
+			continue;
+		}
+
+		view->bTimeSlicedTracesRequested = false;
+
+		if (view->CanUpdateTargets())
+		{
+			const auto viewIndex = PassViews.Add(view);
+			PassViewsRefreshed.Add(true);
+
+			view->AddVisibilityTraces(VisibilityTraces, viewIndex);
+		}
+	}
+
+	for (const auto view : Views)
+	{
+		if (view == nullptr || !view->bTargetsRefreshRequested)
+		{
+			continue;
+		}
+
+		view->bTargetsRefreshRequested = false;
+
+		if (!view->CanUpdateTargets())
+		{
+			continue;
+		}
+
+		// Time sliced views run their own cycle, a request arriving mid cycle or while the traces of the last cycle are in flight is covered by that cycle.
+		if (view->AimAssistDataAsset->bTimeSlicedUpdate)
+		{
+			if (!view->IsTimeSlicedUpdatePending() && !PassViews.Contains(view))
+			{
+				view->BeginTimeSlicedUpdate();
+			}
+
+			continue;
+		}
+
+		const auto viewIndex = PassViews.Add(view);
+		PassViewsRefreshed.Add(true);
+
+		view->UpdateTargets();
+		view->AddVisibilityTraces(VisibilityTraces, viewIndex);
+	}
+
+	// Held targets validated in async mode put their obstacle check into the same batch, a view refreshed by the pass picks a target anyway.
+	for (const auto view : Views)
+	{
+		if (view == nullptr || !view->bTargetValidationRequested)
+		{
+			continue;
+		}
+
+		if (PassViews.Contains(view))
+		{
+			view->bTargetValidationRequested = false;
+			continue;
+		}
+
+		const auto viewIndex = PassViews.Add(view);
+		PassViewsRefreshed.Add(false);
+
+		view->AddValidationTrace(VisibilityTraces, viewIndex);
+	}
+
+	if (PassViews.Num() != 0)
+	{
+		TraceVisibility();
+	}
+}
+
+void UUASAimAssistTargetSubsystem::TraceVisibility()
+{
+	UAS_SCOPE_AIM_ASSIST_STAGE(TraceVisibility);
+
+	if (!VisibilityTraceDelegate.IsBound())
+	{
+		VisibilityTraceDelegate.BindUObject(this, &UUASAimAssistTargetSubsystem::OnVisibilityTraceCompleted);
+	}
+
+	NumPendingVisibilityTraces = 0;
+	VisibilityBatchFrame = GFrameCounter;
+
+	// One set of params serves the whole pass, only its ignored actors change from trace to trace.
+	FCollisionQueryParams queryParams(SCENE_QUERY_STAT(AimAssistObstacleCheck), false);
+
+	for (int32 i = 0; i < VisibilityTraces.Num(); ++i)
+	{
+		auto& trace = VisibilityTraces[i];
+		const auto view = PassViews[trace.ViewIndex].Get();
+
+		// The owner and the target actor are ignored, so only another actor can block the socket, async requests copy the params.
+		queryParams.ClearIgnoredActors();
+		queryParams.AddIgnoredActor(view->GetOwner());
+		queryParams.AddIgnoredActor(trace.TargetActor.Get());
+
+		if (view->AimAssistDataAsset->bAsyncObstacleChecks)
+		{
+			trace.Handle = GetWorld()->AsyncLineTraceByProfile(EAsyncTraceType::Single, trace.Start, trace.End, view->ObstacleCheckProfileName, queryParams, &VisibilityTraceDelegate, i);
+			trace.bPending = true;
+			++NumPendingVisibilityTraces;
+			continue;
+		}
+
+		FHitResult hitResult;
+		GetWorld()->LineTraceSingleByProfile(hitResult, trace.Start, trace.End, view->ObstacleCheckProfileName, queryParams);
+		trace.bVisible = !hitResult.bBlockingHit;
+
+#if ENABLE_DRAW_DEBUG
+		if (view->bDebugTargetTraces)
+		{
+			::DrawDebugLine(GetWorld(), trace.Start, trace.End, trace.bVisible ? FColor::Green : FColor::Red, false, 5.f);
+		}
+#endif
+	}
+
+	if (NumPendingVisibilityTraces == 0)
+	{
+		ResolveVisibility();
+	}
+}
+
+void UUASAimAssistTargetSubsystem::OnVisibilityTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	const auto index = static_cast<int32>(Datum.UserData);
+
+	// Handles are unique per batch, a late result of a given up batch never lands in a newer one.
+	if (NumPendingVisibilityTraces == 0 || !VisibilityTraces.IsValidIndex(index) || VisibilityTraces[index].Handle != Handle || !VisibilityTraces[index].bPending)
+	{
+		return;
+	}
+
+	auto& trace = VisibilityTraces[index];
+	trace.bPending = false;
+	trace.bVisible = FHitResult::GetFirstBlockingHit(Datum.OutHits) == nullptr;
+
+#if ENABLE_DRAW_DEBUG
+	const auto view = PassViews[trace.ViewIndex].Get();
+
+	if (view != nullptr && view->bDebugTargetTraces)
+	{
+		::DrawDebugLine(GetWorld(), Datum.Start, Datum.End, trace.bVisible ? FColor::Green : FColor::Red, false, 5.f);
+	}
+#endif
+
+	if (--NumPendingVisibilityTraces == 0)
+	{
+		ResolveVisibility();
+	}
+}
+
+void UUASAimAssistTargetSubsystem::ResolveVisibility()
+{
+	UAS_SCOPE_AIM_ASSIST_STAGE(HandleTargets);
+
+	for (const auto& view : PassViews)
+	{
+		if (view.IsValid())
+		{
+			view->ApplyScoringResult();
+		}
+	}
+
+	for (const auto& trace : VisibilityTraces)
+	{
+		const auto view = PassViews[trace.ViewIndex].Get();
+
+		if (view != nullptr && trace.bValidation)
+		{
+			view->ResolveValidationTrace(trace);
+			continue;
+		}
+
+		// A trace given up keeps the visibility of the last evaluation of its row.
+		if (view != nullptr && !trace.bPending && view->TargetTable.Visibilities.IsValidIndex(trace.TableRow))
+		{
+			view->TargetTable.Visibilities[trace.TableRow] = trace.bVisible && trace.TargetData.IsValid();
+		}
+	}
+
+	// Rows skipped by the LOD schedule keep the visibility of their last evaluation.
+	for (int32 i = 0; i < PassViews.Num(); ++i)
+	{
+		const auto view = PassViews[i].Get();
+
+		if (view != nullptr && PassViewsRefreshed[i])
+		{
+			view->GatherVisibleTargets();
+
+			if (view->CanUpdateTargets())
+			{
+				view->SelectCurrentTarget();
+			}
+		}
+	}
+
+	VisibilityTraces.Reset();
+}
+
+void UUASAimAssistTargetSubsystem::QueryTargets(const FVector& Location, const FQuat& Rotation, const FVector& Extents, const AActor* IgnoredActor, TArray<UUASAimAssistTargetComponent*>& OutTargets)
+{
+	OutTargets.Reset();
+
+	UpdateGrid();
+
+	if (GridCells.Num() == 0)
+	{
+		return;
+	}
+
+	// Targets are inserted into every cell they overlap, so the cells of the box alone hold every candidate.
+	const auto axisX = Rotation.GetAxisX().GetAbs() * Extents.X;
+	const auto axisY = Rotation.GetAxisY().GetAbs() * Extents.Y;
+	const auto axisZ = Rotation.GetAxisZ().GetAbs() * Extents.Z;
+	const auto worldExtents = axisX + axisY + axisZ;
+
+	const auto minCell = GetCell(Location - worldExtents);
+	const auto maxCell = GetCell(Location + worldExtents);
+
+	if (++QueryStamp == 0)
+	{
+		for (auto& entry : TargetEntries)
+		{
+			entry.QueryStamp = 0;
+		}
+
+		QueryStamp = 1;
+	}
+
+	const auto addIfInside = [&](int32 TargetIndex) {
+		auto& entry = TargetEntries[TargetIndex];
+
+		if (entry.QueryStamp == QueryStamp)
+		{
+			return;
+		}
+
+		entry.QueryStamp = QueryStamp;
+
+		const auto& bounds = entry.Bounds;
+		const auto local = Rotation.UnrotateVector(bounds.Center - Location).GetAbs();
+
+		if (local.X > Extents.X + bounds.W || local.Y > Extents.Y + bounds.W || local.Z > Extents.Z + bounds.W)
+		{
+			return;
+		}
+
+		const auto target = Targets[TargetIndex];
+
+		if (IgnoredActor != nullptr && target->GetOwner() == IgnoredActor)
+		{
+			return;
+		}
+
+		OutTargets.Add(target);
+	};
+
+	// A box spanning more cells than there are occupied cells is cheaper to answer by testing every target, this also bounds the cost of a tiny cell size.
+	const auto numCells = int64(maxCell.X - minCell.X + 1) * int64(maxCell.Y - minCell.Y + 1) * int64(maxCell.Z - minCell.Z + 1);
+
+	if (numCells > GridCells.Num())
+	{
+		for (int32 i = 0; i < TargetEntries.Num(); ++i)
+		{
+			if (TargetEntries[i].bInGrid)
+			{
+				addIfInside(i);
+			}
+		}
+
+		return;
+	}
+
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				if (const auto cell = GridCells.Find(PackCell({ x, y, z })))
+				{
+					for (const auto targetIndex : *cell)
+					{
+						addIfInside(targetIndex);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UUASAimAssistTargetSubsystem::UpdateGrid()
+{
+	if (GridFrameNumber == GFrameCounter)
+	{
+		return;
+	}
+
+	GridFrameNumber = GFrameCounter;
+
+	// Never smaller than what keeps the whole world inside the packed cell range.
+	const auto cellSize = FMath::Max(CVarAimAssistTargetGridCellSize.GetValueOnGameThread(), float(WORLD_MAX) / float(MaxPackedCell));
+
+	if (cellSize != CellSize)
+	{
+		CellSize = cellSize;
+		GridCells.Reset();
+
+		for (auto& entry : TargetEntries)
+		{
+			entry.bInGrid = false;
+		}
+	}
+
+	// Backwards, so a removed slot is filled by a target that is already up to date.
+	for (int32 i = Targets.Num() - 1; i >= 0; --i)
+	{
+		const auto target = Targets[i];
+
+		if (target == nullptr)
+		{
+			RemoveTargetAt(i);
+			continue;
+		}
+
+		if (!target->IsTargetActive())
+		{
+			RemoveFromGrid(i);
+			continue;
+		}
+
+		const auto box = GetTargetBox(*target);
+		const auto minCell = GetCell(box.Min);
+		const auto maxCell = GetCell(box.Max);
+
+		auto& entry = TargetEntries[i];
+		entry.Bounds = FSphere(box.GetCenter(), box.GetExtent().Size());
+
+		// Only a target that crossed a cell border touches the grid.
+		if (entry.bInGrid && entry.MinCell == minCell && entry.MaxCell == maxCell)
+		{
+			continue;
+		}
+
+		RemoveFromGrid(i);
+		entry.MinCell = minCell;
+		entry.MaxCell = maxCell;
+		AddToGrid(i);
+	}
+}
+
+void UUASAimAssistTargetSubsystem::AddToGrid(int32 TargetIndex)
+{
+	auto& entry = TargetEntries[TargetIndex];
+
+	for (int32 x = entry.MinCell.X; x <= entry.MaxCell.X; ++x)
+	{
+		for (int32 y = entry.MinCell.Y; y <= entry.MaxCell.Y; ++y)
+		{
+			for (int32 z = entry.MinCell.Z; z <= entry.MaxCell.Z; ++z)
+			{
+				GridCells.FindOrAdd(PackCell({ x, y, z })).Add(TargetIndex);
+			}
+		}
+	}
+
+	entry.bInGrid = true;
+}
+
+void UUASAimAssistTargetSubsystem::RemoveFromGrid(int32 TargetIndex)
+{
+	auto& entry = TargetEntries[TargetIndex];
+
+	if (!entry.bInGrid)
+	{
+		return;
+	}
+
+	for (int32 x = entry.MinCell.X; x <= entry.MaxCell.X; ++x)
+	{
+		for (int32 y = entry.MinCell.Y; y <= entry.MaxCell.Y; ++y)
+		{
+			for (int32 z = entry.MinCell.Z; z <= entry.MaxCell.Z; ++z)
+			{
+				const auto key = PackCell({ x, y, z });
+				auto& cell = GridCells.FindChecked(key);
+				cell.RemoveSingleSwap(TargetIndex, false);
+
+				if (cell.Num() == 0)
+				{
+					GridCells.Remove(key);
+				}
+			}
+		}
+	}
+
+	entry.bInGrid = false;
+}
+
+FBox UUASAimAssistTargetSubsystem::GetTargetBox(const UUASAimAssistTargetComponent& Target)
+{
+	auto box = Target.GetMesh()->Bounds.GetBox();
+
+	if (Target.IsSocketCacheValid())
+	{
+		for (const auto& socket : Target.CachedSockets)
+		{
+			box += socket.Location;
+		}
+	}
+
+	return box;
+}
+
+FIntVector UUASAimAssistTargetSubsystem::GetCell(const FVector& Location) const
+{
+	// Locations past the world bounds share the border cells instead of wrapping into cells on the other side.
+	const auto getCoordinate = [this](double Value) { return FMath::Clamp(FMath::FloorToInt(Value / CellSize), -MaxPackedCell, MaxPackedCell - 1); };
+
+	return FIntVector(getCoordinate(Location.X), getCoordinate(Location.Y), getCoordinate(Location.Z));
+}
+
+uint64 UUASAimAssistTargetSubsystem::PackCell(const FIntVector& Cell)
+{
+	constexpr uint64 mask = (1ull << 21) - 1;
+	constexpr int32 offset = MaxPackedCell;
+
+	checkSlow(Cell.X >= -MaxPackedCell && Cell.X < MaxPackedCell && Cell.Y >= -MaxPackedCell && Cell.Y < MaxPackedCell && Cell.Z >= -MaxPackedCell && Cell.Z < MaxPackedCell);
+
+	return (uint64(Cell.X + offset) & mask) | ((uint64(Cell.Y + offset) & mask) << 21) | ((uint64(Cell.Z + offset) & mask) << 42);
+}
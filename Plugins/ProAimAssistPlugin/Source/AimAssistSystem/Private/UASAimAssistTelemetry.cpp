@@ -0,0 +1,191 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistTelemetry.h"
+
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimAssistTelemetry, Log, All);
+
+void FUASAimAssistTelemetryFrame::Reset()
+{
+	CandidateLocations.Reset();
+	CandidateScreenLocations.Reset();
+	CandidateIds.Reset();
+	bTargetsRefreshed = false;
+	CurrentCandidate = INDEX_NONE;
+	ActiveZones = 0;
+	PitchMultiplier = 1.f;
+	YawMultiplier = 1.f;
+}
+
+FArchive& operator<<(FArchive& Ar, FUASAimAssistTelemetryFrame& Frame)
+{
+	Ar << Frame.Time;
+	Ar << Frame.DeltaTime;
+	Ar << Frame.bTargetsRefreshed;
+	Ar << Frame.CameraLocation;
+	Ar << Frame.CameraRotation;
+	Ar << Frame.ControlRotation;
+	Ar << Frame.ViewProjectionMatrix;
+	Ar << Frame.ViewRect;
+	Ar << Frame.CandidateLocations;
+	Ar << Frame.CandidateScreenLocations;
+	Ar << Frame.CandidateIds;
+	Ar << Frame.CurrentCandidate;
+	Ar << Frame.ActiveZones;
+	Ar << Frame.PitchMultiplier;
+	Ar << Frame.YawMultiplier;
+	Ar << Frame.CrosshairPosition;
+
+	return Ar;
+}
+
+FUASAimAssistTelemetryRecorder::~FUASAimAssistTelemetryRecorder()
+{
+	Stop();
+}
+
+bool FUASAimAssistTelemetryRecorder::Start(const FString& FilePath)
+{
+	Stop();
+
+	auto& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	platformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	FileHandle.Reset(platformFile.OpenWrite(*FilePath));
+
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogAimAssistTelemetry, Error, TEXT("Failed to open %s for aim assist telemetry."), *FilePath);
+		return false;
+	}
+
+	auto magic = FileMagic;
+	auto version = FileVersion;
+
+	TArray<uint8> header;
+	FMemoryWriter writer(header);
+	writer << magic;
+	writer << version;
+
+	FileHandle->Write(header.GetData(), header.Num());
+
+	for (auto& chunk : Chunks)
+	{
+		chunk.Reset(ChunkSize);
+	}
+
+	CurrentChunk = 0;
+	NumDroppedFrames = 0;
+
+	return true;
+}
+
+void FUASAimAssistTelemetryRecorder::Record(FUASAimAssistTelemetryFrame& Frame)
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	if (!ChunkWriteTasks[CurrentChunk].IsCompleted())
+	{
+		++NumDroppedFrames;
+		return;
+	}
+
+	FMemoryWriter writer(Chunks[CurrentChunk], false, true);
+	writer << Frame;
+
+	if (Chunks[CurrentChunk].Num() >= ChunkSize)
+	{
+		Flush();
+	}
+}
+
+void FUASAimAssistTelemetryRecorder::Stop()
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	if (Chunks[CurrentChunk].Num() != 0 && ChunkWriteTasks[CurrentChunk].IsCompleted())
+	{
+		Flush();
+	}
+
+	WriteTask.Wait();
+	WriteTask = {};
+
+	for (auto& task : ChunkWriteTasks)
+	{
+		task = {};
+	}
+
+	if (NumDroppedFrames != 0)
+	{
+		UE_LOG(LogAimAssistTelemetry, Warning, TEXT("Aim assist telemetry dropped %d frames, the disk could not keep up."), NumDroppedFrames);
+	}
+
+	FileHandle.Reset();
+}
+
+bool FUASAimAssistTelemetryRecorder::Load(const FString& FilePath, TArray<FUASAimAssistTelemetryFrame>& OutFrames)
+{
+	OutFrames.Reset();
+
+	TArray<uint8> data;
+
+	if (!FFileHelper::LoadFileToArray(data, *FilePath))
+	{
+		UE_LOG(LogAimAssistTelemetry, Error, TEXT("Failed to read aim assist telemetry %s."), *FilePath);
+		return false;
+	}
+
+	FMemoryReader reader(data);
+
+	uint32 magic = 0;
+	int32 version = 0;
+	reader << magic;
+	reader << version;
+
+	if (magic != FileMagic || version != FileVersion)
+	{
+		UE_LOG(LogAimAssistTelemetry, Error, TEXT("%s is not an aim assist telemetry recording of version %d."), *FilePath, FileVersion);
+		return false;
+	}
+
+	while (!reader.AtEnd() && !reader.IsError())
+	{
+		reader << OutFrames.AddDefaulted_GetRef();
+	}
+
+	if (reader.IsError())
+	{
+		// A recording cut off mid frame keeps every frame before the damaged one.
+		OutFrames.Pop(false);
+	}
+
+	return true;
+}
+
+void FUASAimAssistTelemetryRecorder::Flush()
+{
+	const auto chunkIndex = CurrentChunk;
+	const auto write = [this, chunkIndex]() {
+		auto& chunk = Chunks[chunkIndex];
+		FileHandle->Write(chunk.GetData(), chunk.Num());
+		chunk.Reset();
+	};
+
+	// Chunks are reused round robin, the write of a chunk has to finish before the game thread fills it again.
+	WriteTask = WriteTask.IsValid() ? UE::Tasks::Launch(TEXT("AimAssistTelemetryWrite"), write, UE::Tasks::Prerequisites(WriteTask)) : UE::Tasks::Launch(TEXT("AimAssistTelemetryWrite"), write);
+	ChunkWriteTasks[chunkIndex] = WriteTask;
+
+	CurrentChunk = (CurrentChunk + 1) % NumChunks;
+}
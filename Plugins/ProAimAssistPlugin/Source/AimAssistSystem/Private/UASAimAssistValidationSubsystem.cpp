@@ -0,0 +1,319 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#include "UASAimAssistValidationSubsystem.h"
+
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "UASAimAssistComponent.h"
+#include "UASAimAssistConfigDataAsset.h"
+#include "UASAimAssistTargetSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogAimAssistValidation, Log, All);
+
+static TAutoConsoleVariable<bool> CVarAimAssistServerValidation(
+	TEXT("AimAssist.ServerValidation"),
+	false,
+	TEXT("Evaluate the aim assist zones of every connected player on the server and report players whose view converges on targets faster than their config allows."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistServerValidationTolerance(
+	TEXT("AimAssist.ServerValidation.Tolerance"),
+	1.5f,
+	TEXT("Multiplier over the auto aim convergence allowed before a frame counts as divergent."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAimAssistServerValidationWindow(
+	TEXT("AimAssist.ServerValidation.Window"),
+	120,
+	TEXT("Number of in-zone frames a divergence score is computed over."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistServerValidationThreshold(
+	TEXT("AimAssist.ServerValidation.Threshold"),
+	0.5f,
+	TEXT("Share of divergent frames in a window that flags the player."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAimAssistServerValidationMinConsecutiveFrames(
+	TEXT("AimAssist.ServerValidation.MinConsecutiveFrames"),
+	3,
+	TEXT("Number of consecutive too fast in-zone frames before they count as divergent, shorter runs are treated as manual flicks."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistServerValidationReferenceFOV(
+	TEXT("AimAssist.ServerValidation.ReferenceFOV"),
+	90.f,
+	TEXT("Horizontal field of view used to convert zone radii from pixels to angles for players without a camera manager."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarAimAssistServerValidationReferenceWidth(
+	TEXT("AimAssist.ServerValidation.ReferenceWidth"),
+	1920.f,
+	TEXT("Viewport width used to convert zone radii from pixels to angles."),
+	ECVF_Default);
+
+void UUASAimAssistValidationSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ApplyResults();
+
+	const auto netMode = GetWorld()->GetNetMode();
+
+	if (!CVarAimAssistServerValidation.GetValueOnGameThread() || netMode == NM_Client || netMode == NM_Standalone)
+	{
+		return;
+	}
+
+	GatherInputs(DeltaTime);
+
+	if (Inputs.Num() == 0)
+	{
+		return;
+	}
+
+	EvaluationTask = UE::Tasks::Launch(TEXT("AimAssistValidation"), [this]() {
+		ParallelFor(
+		    Inputs.Num(),
+		    [this](int32 Index) { EvaluatePlayer(Inputs[Index], CandidateLocations, CandidateTargets); },
+		    Inputs.Num() < 8 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	});
+}
+
+TStatId UUASAimAssistValidationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UUASAimAssistValidationSubsystem, STATGROUP_Tickables);
+}
+
+void UUASAimAssistValidationSubsystem::Deinitialize()
+{
+	if (EvaluationTask.IsValid())
+	{
+		EvaluationTask.Wait();
+		EvaluationTask = {};
+	}
+
+	Super::Deinitialize();
+}
+
+void UUASAimAssistValidationSubsystem::ApplyResults()
+{
+	if (!EvaluationTask.IsValid())
+	{
+		return;
+	}
+
+	EvaluationTask.Wait();
+	EvaluationTask = {};
+
+	for (const auto& player : InputPlayers)
+	{
+		auto state = PlayerStates.Find(player);
+
+		if (state == nullptr || !state->bFlagged)
+		{
+			continue;
+		}
+
+		state->bFlagged = false;
+
+		if (player.IsValid())
+		{
+			UE_LOG(LogAimAssistValidation, Warning, TEXT("%s aim assist divergence score %.2f"), *player->GetName(), state->Score);
+			OnAimAssistDivergenceDelegate.Broadcast(player.Get(), state->Score);
+		}
+	}
+}
+
+void UUASAimAssistValidationSubsystem::GatherInputs(float DeltaTime)
+{
+	Inputs.Reset();
+	InputPlayers.Reset();
+	CandidateLocations.Reset();
+	CandidateTargets.Reset();
+
+	const auto targetSubsystem = GetWorld()->GetSubsystem<UUASAimAssistTargetSubsystem>();
+
+	if (targetSubsystem == nullptr)
+	{
+		return;
+	}
+
+	for (auto it = PlayerStates.CreateIterator(); it; ++it)
+	{
+		if (!it->Key.IsValid())
+		{
+			it.RemoveCurrent();
+		}
+	}
+
+	// States are added before any pointer into the map is taken so the pointers stay valid for the task.
+	for (auto it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		if (it->IsValid() && (*it)->GetPawn() != nullptr)
+		{
+			PlayerStates.FindOrAdd(*it);
+		}
+	}
+
+	const auto tolerance = CVarAimAssistServerValidationTolerance.GetValueOnGameThread();
+	const auto threshold = CVarAimAssistServerValidationThreshold.GetValueOnGameThread();
+	const auto windowSize = FMath::Max(CVarAimAssistServerValidationWindow.GetValueOnGameThread(), 1);
+	const auto minConsecutiveFrames = FMath::Max(CVarAimAssistServerValidationMinConsecutiveFrames.GetValueOnGameThread(), 1);
+	const auto referenceWidth = CVarAimAssistServerValidationReferenceWidth.GetValueOnGameThread();
+	const auto referenceFOV = CVarAimAssistServerValidationReferenceFOV.GetValueOnGameThread();
+
+	for (auto it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		const auto player = it->Get();
+
+		if (player == nullptr || player->GetPawn() == nullptr)
+		{
+			continue;
+		}
+
+		const auto config = FindConfig(player);
+
+		// Any other config would judge the player against zones the client does not use, so the player is not evaluated.
+		if (config == nullptr)
+		{
+			auto& state = PlayerStates.FindChecked(player);
+
+			if (!state.bMissingConfigLogged)
+			{
+				UE_LOG(LogAimAssistValidation, Warning, TEXT("%s has not reported an aim assist config, the player is not validated."), *player->GetName());
+				state.bMissingConfigLogged = true;
+			}
+
+			continue;
+		}
+
+		if (!config->bAutoAimConfig && !config->bMagnetismZoneConfig)
+		{
+			continue;
+		}
+
+		// Zoomed views shrink the zones in world space, so the radii are converted with the FOV the player actually sees.
+		const auto fov = player->PlayerCameraManager != nullptr ? player->PlayerCameraManager->GetFOVAngle() : referenceFOV;
+		const auto focalLength = referenceWidth * 0.5f / FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(fov, 1.f, 170.f) * 0.5f));
+
+		FVector viewLocation;
+		FRotator viewRotation;
+		player->GetPlayerViewPoint(viewLocation, viewRotation);
+
+		const auto viewDirection = viewRotation.Vector();
+		const auto extents = FVector(config->AimAreaExtents.X * 0.5f, config->AimAreaExtents.Y, config->AimAreaExtents.Z);
+
+		targetSubsystem->QueryTargets(viewLocation + viewDirection * extents.X, viewRotation.Quaternion(), extents, player->GetPawn(), QueriedTargets);
+
+		auto& input = Inputs.AddDefaulted_GetRef();
+		input.State = PlayerStates.Find(player);
+		input.ViewLocation = viewLocation;
+		input.ViewDirection = viewDirection;
+		input.DeltaTime = DeltaTime;
+		input.AutoAimZoneAngle = config->bAutoAimConfig ? FMath::Atan(config->AutoAimConfig.AutoAimZoneRadius / focalLength) : 0.f;
+		input.MagnetismStartAngle = config->bMagnetismZoneConfig ? FMath::Atan(config->MagnetismZoneConfig.StartRadius / focalLength) : 0.f;
+		input.MagnetismAimAngle = config->bMagnetismZoneConfig ? FMath::Atan(config->MagnetismZoneConfig.AimZoneRadius / focalLength) : 0.f;
+		input.ActivationDistanceSquared = FMath::Square(config->AutoAimConfig.ActivationDistance);
+		input.AutoAimSpeed = config->AutoAimConfig.Speed;
+		input.bAutoAimOnlyWithInactiveMagnetism = config->AutoAimConfig.bUseOnlyWithInactiveMagnetism;
+		input.Tolerance = tolerance;
+		input.Threshold = threshold;
+		input.WindowSize = windowSize;
+		input.MinConsecutiveFrames = minConsecutiveFrames;
+		input.FirstCandidate = CandidateLocations.Num();
+
+		for (const auto target : QueriedTargets)
+		{
+			target->GetAimTargetSocketLocations(SocketLocations);
+
+			for (const auto& socketData : SocketLocations)
+			{
+				CandidateLocations.Add(socketData.Location);
+				CandidateTargets.Add(target->GetUniqueID());
+			}
+		}
+
+		input.NumCandidates = CandidateLocations.Num() - input.FirstCandidate;
+		InputPlayers.Add(player);
+	}
+}
+
+void UUASAimAssistValidationSubsystem::EvaluatePlayer(const FPlayerInput& Input, TConstArrayView<FVector> CandidateLocations, TConstArrayView<int32> CandidateTargets)
+{
+	auto& state = *Input.State;
+
+	auto bestTarget = INDEX_NONE;
+	auto bestAngle = TNumericLimits<float>::Max();
+	auto bestDistanceSquared = 0.f;
+
+	for (int32 i = Input.FirstCandidate; i < Input.FirstCandidate + Input.NumCandidates; ++i)
+	{
+		const auto toTarget = CandidateLocations[i] - Input.ViewLocation;
+		const auto angle = FMath::Acos(FMath::Clamp<float>(FVector::DotProduct(toTarget.GetSafeNormal(), Input.ViewDirection), -1.f, 1.f));
+
+		if (angle < bestAngle)
+		{
+			bestAngle = angle;
+			bestTarget = CandidateTargets[i];
+			bestDistanceSquared = toTarget.SizeSquared();
+		}
+	}
+
+	const auto autoAimZoneAngle = bestDistanceSquared <= Input.ActivationDistanceSquared ? Input.AutoAimZoneAngle : 0.f;
+
+	if (bestTarget == INDEX_NONE || bestAngle > FMath::Max(autoAimZoneAngle, Input.MagnetismStartAngle))
+	{
+		state.LastTargetIndex = INDEX_NONE;
+		state.NumConsecutiveDivergentSamples = 0;
+		return;
+	}
+
+	if (state.LastTargetIndex == bestTarget)
+	{
+		const auto bMagnetism = state.LastTargetAngle <= Input.MagnetismStartAngle;
+		const auto bAutoAim = state.LastTargetAngle <= autoAimZoneAngle && !(bMagnetism && Input.bAutoAimOnlyWithInactiveMagnetism);
+
+		// Auto aim uses RInterpTo, which closes at most DeltaTime * Speed of the remaining angle per frame. Magnetism leaves the
+		// view alone and moves the crosshair by up to its aim radius, a view snapping further than that in one frame is not it.
+		auto allowed = bAutoAim ? state.LastTargetAngle * FMath::Clamp(Input.DeltaTime * Input.AutoAimSpeed, 0.f, 1.f) : 0.f;
+
+		if (bMagnetism)
+		{
+			allowed = FMath::Max(allowed, Input.MagnetismAimAngle);
+		}
+
+		const auto observed = state.LastTargetAngle - bestAngle;
+
+		++state.NumSamples;
+
+		state.NumConsecutiveDivergentSamples = observed > allowed * Input.Tolerance ? state.NumConsecutiveDivergentSamples + 1 : 0;
+
+		if (state.NumConsecutiveDivergentSamples >= Input.MinConsecutiveFrames)
+		{
+			++state.NumDivergentSamples;
+		}
+
+		if (state.NumSamples >= Input.WindowSize)
+		{
+			state.Score = static_cast<float>(state.NumDivergentSamples) / state.NumSamples;
+			state.bFlagged = state.Score >= Input.Threshold;
+			state.NumSamples = 0;
+			state.NumDivergentSamples = 0;
+		}
+	}
+
+	state.LastTargetIndex = bestTarget;
+	state.LastTargetAngle = bestAngle;
+}
+
+UUASAimAssistConfigDataAsset* UUASAimAssistValidationSubsystem::FindConfig(APlayerController* Player) const
+{
+	// The editor assigned asset of the server side component says nothing about what the client runs, only its report does.
+	const auto component = Player->FindComponentByClass<UUASAimAssistComponent>();
+
+	return component != nullptr ? component->GetReportedDataAsset() : nullptr;
+}
@@ -0,0 +1,50 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "UASAimAssistBenchmarkCommandlet.generated.h"
+
+class UWorld;
+
+/**
+ * Headless aim assist benchmark.
+ * Spawns swarms of synthetic targets, sweeps a scripted camera across them and writes per stage timings as CSV and JSON.
+ * Stage timings come from the same UAS_SCOPE_AIM_ASSIST_STAGE scopes that feed the STAT_ counters of the AimAssist stats group.
+ *
+ * UnrealEditor-Cmd <Project> -run=UASAimAssistBenchmark -nullrhi [-Targets=10,100,1000] [-Sockets=3] [-Frames=600] [-Output=<path without extension>]
+ */
+UCLASS()
+class AIMASSISTSYSTEM_API UUASAimAssistBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUASAimAssistBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	struct FStageResult
+	{
+		int32 NumTargets = 0;
+		int32 NumSockets = 0;
+		FString Stage;
+		double Mean = 0.0;
+		double P50 = 0.0;
+		double P90 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	/** Runs one scenario per target count, shared by the commandlet and the AimAssist.Benchmark automation test. */
+	static void RunScenarios(const TArray<int32>& NumTargets, int32 NumSockets, int32 NumFrames, TArray<FStageResult>& OutResults);
+
+	static bool WriteReports(const FString& OutputPath, const TArray<FStageResult>& Results);
+
+protected:
+	static void RunScenario(int32 NumTargets, int32 NumSockets, int32 NumFrames, TArray<FStageResult>& OutResults);
+
+	static void AddStageResult(int32 NumTargets, int32 NumSockets, const TCHAR* Stage, TArray<double>& Samples, TArray<FStageResult>& OutResults);
+};
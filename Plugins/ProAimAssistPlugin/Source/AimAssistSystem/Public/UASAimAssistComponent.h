@@ -5,13 +5,21 @@
 #include "Components/ActorComponent.h"
 #include "CoreMinimal.h"
 #include "Curves/CurveFloat.h"
+#include "Engine/World.h"
 #include "Engine/Canvas.h"
 #include "GameFramework/HUD.h"
+#include "Tasks/Task.h"
+#include "UASAimAssistTargetComponent.h"
+#include "UASAimAssistTelemetry.h"
 
 #include "UASAimAssistComponent.generated.h"
 
+class FViewport;
+class SWindow;
 class UUASAimAssistTargetComponent;
 class UUASAimAssistConfigDataAsset;
+struct FUASCurveLookupTable;
+struct FUASVisibilityTrace;
 
 USTRUCT()
 struct AIMASSISTSYSTEM_API FUASAimAssistTargetData
@@ -19,21 +27,108 @@ struct AIMASSISTSYSTEM_API FUASAimAssistTargetData
 public:
 	GENERATED_BODY()
 public:
-	bool operator==(const FUASAimAssistTargetData& A) const { return A.TargetComponent == TargetComponent && A.SocketName == SocketName; }
+	bool operator==(const FUASAimAssistTargetData& A) const { return A.TargetComponent == TargetComponent && A.SocketIndex == SocketIndex; }
 
-	FVector2D GetLocationOnTheScreen(APlayerController* Controller) const;
 	FVector GetSocketLocation() const;
 
+	FVector GetPredictedSocketLocation(float LeadTime) const;
+
 	bool IsValid() const;
 	TWeakObjectPtr<UUASAimAssistTargetComponent> TargetComponent;
-	FName SocketName;
+	int32 SocketIndex = INDEX_NONE;
+};
+
+/** Evaluation schedule of one target of the table, its rows are the sockets 0 to NumRows - 1. */
+struct FUASAimAssistTargetSchedule
+{
+	TWeakObjectPtr<UUASAimAssistTargetComponent> Component;
+	double NextEvaluationTime = 0.0;
+	int32 NumRows = 0;
+	uint32 Generation = 0;
 };
 
+/**
+ * Flat structure of arrays with one row per target socket inside the aim area.
+ * Rows are stamped with the refresh cycle that last saw them, rows left behind by a cycle are swapped out in one sweep.
+ */
+struct AIMASSISTSYSTEM_API FUASAimAssistTargetTable
+{
+public:
+	/** Starts the evaluation of a target with NumRows sockets, rows of the sockets past NumRows are retired right away. */
+	void Schedule(UUASAimAssistTargetComponent* Component, int32 NumRows, uint32 Generation, double NextEvaluationTime = 0.0);
+
+	int32 Touch(UUASAimAssistTargetComponent* Component, const FUASSocketData& Socket, uint32 Generation);
+
+	/** Carries the rows of a target over to Generation without re-evaluating them, false once the target is due. */
+	bool KeepIfScheduled(const UUASAimAssistTargetComponent* Component, uint32 Generation, double Now);
+
+	/** Collects the known targets that are due without querying the grid, every row starts the pass unevaluated. */
+	void CollectDueTargets(double Now, TArray<UUASAimAssistTargetComponent*>& OutComponents);
+
+	void RemoveStale(uint32 Generation);
+
+	void Reset();
+
+	int32 Num() const { return Components.Num(); }
+
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<TWeakObjectPtr<UUASAimAssistTargetComponent>> Components;
+	TArray<int32> SocketIndices;
+	TArray<FVector> Locations;
+	TArray<uint32> Generations;
+
+	/** Rows touched by the current refresh, the others keep their visibility from an earlier one. */
+	TArray<bool> Evaluated;
+	TArray<bool> Visibilities;
+
+protected:
+	void RemoveAtSwap(int32 Row);
+
+	static uint64 MakeKey(const UUASAimAssistTargetComponent* Component, int32 SocketIndex);
+
+	TArray<uint64> Keys;
+	TMap<uint64, int32> RowsByKey;
+
+	/** Keyed by the unique id of the target component like the row keys. */
+	TMap<uint32, FUASAimAssistTargetSchedule> Schedules;
+};
+
+/** Viewport dependent inputs of the aim assist math, refreshed on viewport resize, DPI change and data asset change. */
+struct AIMASSISTSYSTEM_API FUASAimAssistViewState
+{
+public:
+	FVector2D ScreenCenter = FVector2D::ZeroVector;
+	float DPIScale = 1.f;
+
+	/** Zone radii from the data asset with the DPI scale applied, the per target zones scale is applied on top. */
+	float StickinessRadius = 0.f;
+	float MagnetismStartRadius = 0.f;
+	float MagnetismAimRadius = 0.f;
+	float AutoAimRadius = 0.f;
+
+	bool bScaledByDPI = false;
+	bool bValid = false;
+};
+
+/** Features of the evaluation pipeline, every combination has its own instantiation of the tick stages. */
+enum class EUASAimAssistFeatures : uint8
+{
+	None = 0,
+	Stickiness = 1 << 0,
+	Magnetism = 1 << 1,
+	Scaling = 1 << 2,
+	AutoAim = 1 << 3,
+	All = Stickiness | Magnetism | Scaling | AutoAim
+};
+
+ENUM_CLASS_FLAGS(EUASAimAssistFeatures);
+
 DECLARE_STATS_GROUP(TEXT("AimAssist"), STATGROUP_AimAssist, STATCAT_Advanced);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleCurrentTarget"), STAT_HandleCurrentTarget, STATGROUP_AimAssist, AIMASSISTSYSTEM_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleAutoAim"), STAT_HandleAutoAim, STATGROUP_AimAssist, AIMASSISTSYSTEM_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateTargets"), STAT_UpdateTargets, STATGROUP_AimAssist, AIMASSISTSYSTEM_API);
 DECLARE_CYCLE_STAT_EXTERN(TEXT("HandleTargets"), STAT_HandleTargets, STATGROUP_AimAssist, AIMASSISTSYSTEM_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TraceVisibility"), STAT_TraceVisibility, STATGROUP_AimAssist, AIMASSISTSYSTEM_API);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FUASOnAimDataAssetChangedDelegate, UUASAimAssistConfigDataAsset*, NewAsset);
 
@@ -42,10 +137,16 @@ class AIMASSISTSYSTEM_API UUASAimAssistComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend class UUASAimAssistTargetSubsystem;
+	friend class UUASAimAssistBenchmarkCommandlet;
+	friend class UUASAimAssistReplayCommandlet;
+
 public:
 	UUASAimAssistComponent();
 	
 	virtual  void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
@@ -58,20 +159,92 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "AimAssistComponent")
 	void SetAimAssistDataAsset(UUASAimAssistConfigDataAsset* DataAsset);
 
+	UFUNCTION(BlueprintPure, Category = "AimAssistComponent")
+	UUASAimAssistConfigDataAsset* GetAimAssistDataAsset() const { return AimAssistDataAsset; }
+
+	/** Config the owning client reported through SetAimAssistDataAsset, only set on the server. */
+	UUASAimAssistConfigDataAsset* GetReportedDataAsset() const { return ReportedDataAsset; }
+
 	UFUNCTION(BlueprintPure, Category = "AimAssistComponent")
 	void GetControlMultipliers(float& Pitch, float& Yaw) const;
 
+	UFUNCTION(BlueprintSetter)
+	void SetEnableStickiness(bool bValue);
+
+	UFUNCTION(BlueprintSetter)
+	void SetEnableMagnetism(bool bValue);
+
+	UFUNCTION(BlueprintSetter)
+	void SetEnableScaling(bool bValue);
+
+	UFUNCTION(BlueprintSetter)
+	void SetEnableAutoAim(bool bValue);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/** Streams every evaluated frame to FileName, relative names go to Saved/AimAssistTelemetry. Replay with -run=UASAimAssistReplay. */
+	UFUNCTION(BlueprintCallable, Category = "AimAssistComponent|Telemetry")
+	bool StartTelemetryRecording(const FString& FileName);
+
+	UFUNCTION(BlueprintCallable, Category = "AimAssistComponent|Telemetry")
+	void StopTelemetryRecording();
+
+	/** Recomputes the cached screen centre and zone radii, call it after changing the crosshair offset or zone radii at runtime. */
+	UFUNCTION(BlueprintCallable, Category = "AimAssistComponent")
+	void RefreshViewState();
+
 protected:
 	bool CanUseAssist() const;
 
-	UFUNCTION()
-	void OnTargetDestroyed(AActor* DestroyedActor);
+	/** Tells the server which config the client runs with, UUASAimAssistValidationSubsystem judges the player by it. */
+	UFUNCTION(Server, Reliable)
+	void ServerReportDataAsset(UUASAimAssistConfigDataAsset* DataAsset);
 
 	void UpdateAssist();
 
+	void UpdateAdaptiveSchedule(float DeltaTime);
+
+	bool CanUpdateTargets() const;
+
 	void UpdateTargets();
 
-	void HandleTargets();
+	void UpdateTargetsContext();
+
+	/** Refreshes the table rows of one target, OutTouchedRows receives the rows that need a visibility check. */
+	void UpdateTarget(UUASAimAssistTargetComponent* Component, TArray<int32>* OutTouchedRows = nullptr);
+
+	/** Starts a refresh cycle that ProcessTimeSlice spreads over the next frames, the target is selected once the cycle is done. */
+	void BeginTimeSlicedUpdate();
+
+	bool IsTimeSlicedUpdatePending() const { return PendingTargetIndex < PendingTargets.Num(); }
+
+	void ProcessTimeSlice();
+
+	bool IsRowCulled(int32 Row) const;
+
+	void AddVisibilityTraces(TArray<FUASVisibilityTrace>& OutTraces, int32 ViewIndex);
+
+	void GatherVisibleTargets();
+
+	float GetTargetRelevance(const FVector& Location, const FVector& ViewLocation, const FVector2D& ScreenCenter) const;
+
+	void SelectCurrentTarget();
+
+	void ApplyScoringResult();
+
+	void RecordTelemetry(float DeltaTime, const FRotator& ControlRotation);
+
+	int32 ApplyHysteresis(int32 BestIndex, const FVector2D& ScreenCenter, TConstArrayView<FUASAimAssistTargetData> Targets, TConstArrayView<FVector2D> ScreenLocations) const;
+
+	void ValidateCurrentTarget();
+
+	void AddValidationTrace(TArray<FUASVisibilityTrace>& OutTraces, int32 ViewIndex);
+
+	void ResolveValidationTrace(const FUASVisibilityTrace& Trace);
+
+	void LoseCurrentTarget();
 
 	FVector GetOverlapExtents() const;
 
@@ -80,19 +253,43 @@ protected:
 
 	FVector GetCameraLocation() const;
 
-	FVector2D GetScreenCenter() const;
+	FVector2D GetScreenCenter() const { return ViewState.ScreenCenter; }
+
+	void OnViewportResized(FViewport* Viewport, uint32 Unused);
+
+	void OnWindowDPIScaleChanged(TSharedRef<SWindow> Window);
+
+	void UpdateViewProjection();
 
+	FVector2D ProjectToScreen(const FVector& WorldLocation) const;
+
+	float GetLargestScaledZoneRadius() const;
+
+	bool IsOutsideZones(const FSphere& Bounds, const FVector2D& ScreenCenter, float ZoneRadius) const;
+
+	/** Selects the Evaluate instantiation for the enabled features, rerun by the tick whenever GetRequestedFeatures changes. */
+	void UpdatePipeline();
+
+	/** Features enabled by both the component toggles and the config, cheap enough to compare every tick. */
+	EUASAimAssistFeatures GetRequestedFeatures() const;
+
+	template <EUASAimAssistFeatures Features>
+	void Evaluate(float DeltaTime);
+
+	template <EUASAimAssistFeatures Features>
 	void HandleCurrentTarget();
 
+	template <EUASAimAssistFeatures Features>
 	void HandleAutoAim(float DeltaTime);
 
+	template <EUASAimAssistFeatures Features>
 	void UpdateCrosshair(float DeltaTime);
 
 	void UpdateZonesScaling(float DeltaTime);
 
-	float GetCurveValue(const FRuntimeFloatCurve& Curve, float Power) const;
+	float GetCurveValue(const FRuntimeFloatCurve& Curve, const FUASCurveLookupTable& LookupTable, float Power) const;
 
-	float GetScaledZoneRadius(float From) const;
+	float GetZonesScaleMultiplier() const { return IsScalingEnabled() ? ZonesScaleMultiplier : 1.f; }
 
 #if !UE_BUILD_SHIPPING
 	float GetScaledZoneRadiusForDebug(float From) const;
@@ -103,28 +300,28 @@ protected:
 	void DrawCrosshair(AHUD* HUD, const FVector2D& Position) const;
 #endif
 
-	bool IsMagtetismEnabled() const;
-	bool IsStickinessEnabled() const;
-	bool IsScalingEnabled() const;
-	bool IsAutoAimEnabled() const;
+	bool IsMagtetismEnabled() const { return EnumHasAnyFlags(EnabledFeatures, EUASAimAssistFeatures::Magnetism); }
+	bool IsStickinessEnabled() const { return EnumHasAnyFlags(EnabledFeatures, EUASAimAssistFeatures::Stickiness); }
+	bool IsScalingEnabled() const { return EnumHasAnyFlags(EnabledFeatures, EUASAimAssistFeatures::Scaling); }
+	bool IsAutoAimEnabled() const { return EnumHasAnyFlags(EnabledFeatures, EUASAimAssistFeatures::AutoAim); }
 
 public:
 	UPROPERTY(BlueprintAssignable, Category = "AimAssistComponent")
 	FUASOnAimDataAssetChangedDelegate OnAimDataAssetChangedDelegate;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetEnableStickiness, Category = "AimAssistComponent")
 	bool bEnableStickiness = true;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetEnableMagnetism, Category = "AimAssistComponent")
 	bool bEnableMagnetism = true;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetEnableScaling, Category = "AimAssistComponent")
 	bool bEnableScaling = true;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
 	bool bScalingByDPI = true;
 	
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, BlueprintSetter = SetEnableAutoAim, Category = "AimAssistComponent")
 	bool bEnableAutoAim = true;
 protected:
 	UPROPERTY(EditAnywhere, Category = "AimAssistComponent|Debug")
@@ -145,7 +342,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AimAssistComponent")
 	UUASAimAssistConfigDataAsset* AimAssistDataAsset;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
+	UPROPERTY(Transient)
+	UUASAimAssistConfigDataAsset* ReportedDataAsset = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent", meta = (DeprecatedProperty, DeprecationMessage = "Targets are gathered from UUASAimAssistTargetSubsystem, the profile is no longer used."))
 	FName TargetsDetectionProfileName;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistComponent")
@@ -153,13 +353,87 @@ protected:
 
 	FTimerHandle UpdateTargetsTimerHandle;
 
+	using FEvaluateFunction = void (UUASAimAssistComponent::*)(float);
+
+	EUASAimAssistFeatures EnabledFeatures = EUASAimAssistFeatures::None;
+	FEvaluateFunction EvaluateFunction = nullptr;
+
+	FUASAimAssistViewState ViewState;
+
+	TSharedPtr<FUASAimAssistTelemetryRecorder> TelemetryRecorder;
+	FUASAimAssistTelemetryFrame TelemetryFrame;
+
+	/** A target refresh was requested since the last recorded telemetry frame. */
+	bool bTelemetryTargetsRefreshed = false;
+
+	FDelegateHandle ViewportResizedHandle;
+	FDelegateHandle WindowDPIScaleChangedHandle;
+
+	float TimeSinceTargetsUpdate = 0.f;
+	float AdaptiveUpdateInterval = 0.f;
+	FVector LastUpdateViewLocation = FVector::ZeroVector;
+	FQuat LastUpdateViewRotation = FQuat::Identity;
+	uint32 LastUpdateTargetsGeneration = 0;
+	float LastFullScanTime = -BIG_NUMBER;
+	double NextLODQueryTime = 0.0;
+
 	TWeakObjectPtr<APlayerController> PlayerController;
 
-	TMap<TWeakObjectPtr<AActor>, TArray<TWeakObjectPtr<UUASAimAssistTargetComponent>>> TargetComponents;
+	FUASAimAssistTargetTable TargetTable;
+	uint32 TargetTableGeneration = 0;
+	TArray<UUASAimAssistTargetComponent*> QueriedTargets;
+	TArray<FUASSocketData> SocketLocations;
+
+	struct FScoringBuffer
+	{
+		TArray<FUASAimAssistTargetData> Targets;
+		TArray<FVector> WorldLocations;
+		TArray<FVector2D> ScreenLocations;
+		int32 BestIndex = INDEX_NONE;
+	};
+
+	/** Buffer of the last applied scoring, swapped with the one owned by the task once it completes. */
+	FScoringBuffer ScoringBuffer;
+
+	struct FTargetsContext
+	{
+		FVector2D ScreenCenter = FVector2D::ZeroVector;
+		FVector ViewLocation = FVector::ZeroVector;
+		float ZoneRadius = 0.f;
+		double Now = 0.0;
+		bool bLOD = false;
+	};
+
+	FTargetsContext TargetsContext;
+
+	TArray<TWeakObjectPtr<UUASAimAssistTargetComponent>> PendingTargets;
+	int32 PendingTargetIndex = 0;
+	TArray<int32> TouchedRows;
+
+	FMatrix ViewProjectionMatrix = FMatrix::Identity;
+	FIntRect ViewRect;
+	float ProjectionScale = 1.f;
+	bool bViewProjectionValid = false;
+	uint64 ViewProjectionFrameNumber = MAX_uint64;
+
+	FVector2D CurrentTargetScreenLocation = FVector2D::ZeroVector;
+	FVector2D MagnetismTargetScreenLocation = FVector2D::ZeroVector;
+
+	/** Owns its own snapshot of the candidates, nothing on the component is touched until ApplyScoringResult. */
+	UE::Tasks::TTask<FScoringBuffer> ScoringTask;
 
 	FUASAimAssistTargetData CurrentTargetData;
 	TArray<FUASAimAssistTargetData> LastTargetData;
 
+	/** Set by the refresh timer, consumed by the next shared pass of UUASAimAssistTargetSubsystem. */
+	bool bTargetsRefreshRequested = false;
+
+	/** Obstacle check of the held target waiting for the next async batch of UUASAimAssistTargetSubsystem. */
+	bool bTargetValidationRequested = false;
+
+	/** Finished time sliced cycle whose obstacle checks wait for the next async batch of UUASAimAssistTargetSubsystem. */
+	bool bTimeSlicedTracesRequested = false;
+
 	bool bStickinessAreaActive = false;
 	bool bMagnetismAreaActive = false;
 	bool bAutoAimAreaActive = false;
@@ -8,6 +8,24 @@
 
 #include "UASAimAssistConfigDataAsset.generated.h"
 
+/** Curve sampled at uniform steps over its key range, evaluated by linear interpolation and clamped outside the range. */
+struct AIMASSISTSYSTEM_API FUASCurveLookupTable
+{
+public:
+	void Bake(const FRuntimeFloatCurve& Curve, int32 NumSamples);
+
+	void Reset() { Samples.Reset(); }
+
+	bool IsBaked() const { return Samples.Num() >= 2; }
+
+	float Eval(float Time) const;
+
+protected:
+	TArray<float> Samples;
+	float MinTime = 0.f;
+	float InvStep = 0.f;
+};
+
 USTRUCT(BlueprintType)
 struct AIMASSISTSYSTEM_API FUASStickinessZoneConfig
 {
@@ -36,6 +54,10 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Magnetism", meta = (ClampMin = 0.f, UIMin = 0.f))
 	float AimZoneRadius = 30.f;
+
+	/** Seconds ahead of the target's estimated velocity the crosshair is pulled to, 0 pulls to the current socket location. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Magnetism", meta = (ClampMin = 0.f, UIMin = 0.f))
+	float LeadTime = 0.f;
 };
 
 USTRUCT(BlueprintType)
@@ -72,6 +94,10 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AutoAim", meta = (ClampMin = 0.f, UIMin = 0.f))
 	float TimeToBlockAfterChangeTarget = 0.2f;
+
+	/** Seconds ahead of the target's estimated velocity the camera turns to, 0 turns to the current socket location. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AutoAim", meta = (ClampMin = 0.f, UIMin = 0.f))
+	float LeadTime = 0.f;
 };
 
 UCLASS(BlueprintType)
@@ -79,12 +105,79 @@ class AIMASSISTSYSTEM_API UUASAimAssistConfigDataAsset : public UDataAsset
 {
 	GENERATED_BODY()
 public:
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig")
+	UUASAimAssistConfigDataAsset();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig", meta = (EditCondition = "!bAdaptiveTargetsUpdate && !bTargetLOD"))
 	float UpdateTargetsRate = 0.2f;
 
+	/** Refresh targets on camera jumps and target spawns, backing off while the view and the target set stay stable. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AdaptiveUpdate")
+	bool bAdaptiveTargetsUpdate = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AdaptiveUpdate", meta = (EditCondition = bAdaptiveTargetsUpdate, ClampMin = 0.f, UIMin = 0.f))
+	float MinUpdateTargetsRate = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AdaptiveUpdate", meta = (EditCondition = bAdaptiveTargetsUpdate, ClampMin = 0.f, UIMin = 0.f))
+	float MaxUpdateTargetsRate = 0.8f;
+
+	/** Camera rotation in degrees since the last refresh that forces a new one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AdaptiveUpdate", meta = (EditCondition = bAdaptiveTargetsUpdate, ClampMin = 0.f, UIMin = 0.f))
+	float RefreshRotationThreshold = 10.f;
+
+	/** Camera translation since the last refresh that forces a new one. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|AdaptiveUpdate", meta = (EditCondition = bAdaptiveTargetsUpdate, ClampMin = 0.f, UIMin = 0.f))
+	float RefreshTranslationThreshold = 200.f;
+
+	/** Spread each target refresh over frames, gathering and tracing targets until FrameBudgetMicroseconds is spent. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|TimeSlicing")
+	bool bTimeSlicedUpdate = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|TimeSlicing", meta = (EditCondition = bTimeSlicedUpdate, ClampMin = 1.f, UIMin = 1.f))
+	float FrameBudgetMicroseconds = 200.f;
+
+	/** Refresh targets every frame, evaluating each one at a rate and socket count picked by its relevance. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|LOD")
+	bool bTargetLOD = false;
+
+	/** Seconds between evaluations of a target by relevance, 1 is close to the camera under the crosshair, 0 is at the far end of the aim area or the screen corner. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|LOD", meta = (EditCondition = bTargetLOD))
+	FRuntimeFloatCurve TargetLODIntervalCurve;
+
+	/** Fraction of the target sockets evaluated by relevance, sockets are taken in the order of AimTargetSocketNames. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|LOD", meta = (EditCondition = bTargetLOD))
+	FRuntimeFloatCurve TargetLODSocketsCurve;
+
+	/** Interval of the grid query that picks up new targets, in between only the known targets that are due get evaluated. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|LOD", meta = (EditCondition = bTargetLOD, ClampMin = 0.f, UIMin = 0.f))
+	float TargetLODQueryRate = 0.1f;
+
+	/** Hold the current target while it stays visible, re-tracing only its socket every frame and scanning all candidates at FullScanRate. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Hysteresis")
+	bool bTargetHysteresis = false;
+
+	/** Screen distance beyond the largest zone before the held target is dropped, also the advantage a new candidate needs to replace it. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Hysteresis", meta = (EditCondition = bTargetHysteresis, ClampMin = 0.f, UIMin = 0.f))
+	float HysteresisScreenMargin = 20.f;
+
+	/** Interval of the full candidate scan while a target is held. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Hysteresis", meta = (EditCondition = bTargetHysteresis, ClampMin = 0.f, UIMin = 0.f))
+	float FullScanRate = 0.6f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig")
 	FVector AimAreaExtents = { 5000.f, 300.f, 300.f };
 
+	/** Submit obstacle checks as one batch of async traces, results are applied on the next frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig")
+	bool bAsyncObstacleChecks = false;
+
+	/** Skip obstacle checks for targets whose mesh the renderer has not drawn recently, they are treated as occluded. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig")
+	bool bCullNotRenderedTargets = false;
+
+	/** How long a mesh stays a candidate after it was last rendered. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig", meta = (EditCondition = bCullNotRenderedTargets, ClampMin = 0.f, UIMin = 0.f))
+	float RenderedRecentlyTolerance = 0.2f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (InlineEditConditionToggle), Category = "AimAssistConfig")
 	bool bStickinessZoneConfig = true;
 
@@ -111,4 +204,31 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig")
 	FVector2D CrosshairOffset = FVector2D::ZeroVector;
+
+	/**
+	 * Evaluate the curves exactly instead of through the baked lookup tables.
+	 * The tables interpolate linearly between samples and hold the end values outside the key range, so curves with cubic keys or extrapolation only match approximately.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Curves")
+	bool bExactCurveEvaluation = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistConfig|Curves", meta = (EditCondition = "!bExactCurveEvaluation", ClampMin = 2, UIMin = 2))
+	int32 CurveLookupTableSize = 64;
+
+	/** Rebuilds the curve lookup tables, call it after changing curves at runtime. */
+	UFUNCTION(BlueprintCallable, Category = "AimAssistConfig")
+	void BakeCurves();
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	FUASCurveLookupTable StickinessPitchLookupTable;
+	FUASCurveLookupTable StickinessYawLookupTable;
+	FUASCurveLookupTable ZonesScalingLookupTable;
+	FUASCurveLookupTable TargetLODIntervalLookupTable;
+	FUASCurveLookupTable TargetLODSocketsLookupTable;
+
+	/** Largest zones scale the scaling curve can return, never below 1, refreshed by BakeCurves. */
+	float MaxZonesScale = 1.f;
 };
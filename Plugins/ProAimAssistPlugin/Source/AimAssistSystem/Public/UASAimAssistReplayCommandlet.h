@@ -0,0 +1,45 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "UASAimAssistReplayCommandlet.generated.h"
+
+class UUASAimAssistConfigDataAsset;
+struct FUASAimAssistTelemetryFrame;
+
+/**
+ * Headless aim assist replay.
+ * Feeds the camera and visible candidates of a telemetry recording through a config, writes per frame timings and every difference to the recorded behaviour as CSV.
+ *
+ * UnrealEditor-Cmd <Project> -run=UASAimAssistReplay -nullrhi -Recording=<file> [-Config=<data asset path>] [-Output=<path without extension>]
+ */
+UCLASS()
+class AIMASSISTSYSTEM_API UUASAimAssistReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUASAimAssistReplayCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	struct FFrameResult
+	{
+		double EvaluateUs = 0.0;
+		int32 RecordedTarget = INDEX_NONE;
+		int32 ReplayedTarget = INDEX_NONE;
+		uint8 RecordedZones = 0;
+		uint8 ReplayedZones = 0;
+		float PitchMultiplierDelta = 0.f;
+		float YawMultiplierDelta = 0.f;
+		float CrosshairDelta = 0.f;
+	};
+
+	static bool Replay(const TArray<FUASAimAssistTelemetryFrame>& Frames, UUASAimAssistConfigDataAsset* Config, TArray<FFrameResult>& OutResults);
+
+	static bool WriteReport(const FString& OutputPath, const TArray<FUASAimAssistTelemetryFrame>& Frames, const TArray<FFrameResult>& Results);
+};
@@ -0,0 +1,57 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Stats/Stats.h"
+
+enum class EUASAimAssistStage : uint8
+{
+	UpdateTargets,
+	HandleTargets,
+	TraceVisibility,
+	HandleCurrentTarget,
+	HandleAutoAim,
+	Num
+};
+
+#if !UE_BUILD_SHIPPING
+/** Game thread accumulator of aim assist stage times for offline tools that cannot rely on the stats system. */
+struct AIMASSISTSYSTEM_API FUASAimAssistStageTimings
+{
+	static bool bEnabled;
+	static double Seconds[static_cast<int32>(EUASAimAssistStage::Num)];
+
+	static void Reset();
+
+	static const TCHAR* GetStageName(EUASAimAssistStage Stage);
+};
+
+struct FUASAimAssistStageScope
+{
+	explicit FUASAimAssistStageScope(EUASAimAssistStage InStage)
+	    : Stage(InStage)
+	    , StartTime(FUASAimAssistStageTimings::bEnabled ? FPlatformTime::Seconds() : 0.0)
+	{
+	}
+
+	~FUASAimAssistStageScope()
+	{
+		if (FUASAimAssistStageTimings::bEnabled)
+		{
+			FUASAimAssistStageTimings::Seconds[static_cast<int32>(Stage)] += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+
+	EUASAimAssistStage Stage;
+	double StartTime;
+};
+
+/** Times a stage with its STAT_<Stage> cycle counter and, when enabled, with the offline accumulator, so both always measure the same scope. */
+#define UAS_SCOPE_AIM_ASSIST_STAGE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_##Stage);     \
+	FUASAimAssistStageScope PREPROCESSOR_JOIN(AimAssistStageScope, __LINE__)(EUASAimAssistStage::Stage)
+#else
+#define UAS_SCOPE_AIM_ASSIST_STAGE(Stage) SCOPE_CYCLE_COUNTER(STAT_##Stage)
+#endif
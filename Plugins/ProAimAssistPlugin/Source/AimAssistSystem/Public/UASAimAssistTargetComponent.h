@@ -13,25 +13,39 @@ struct AIMASSISTSYSTEM_API FUASSocketData
 	GENERATED_BODY()
 public:
 	FName SocketName;
+	int32 SocketIndex = INDEX_NONE;
 	FVector Location;
 };
 
 class UMeshComponent;
+class USkinnedMeshComponent;
 
 UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
 class AIMASSISTSYSTEM_API UUASAimAssistTargetComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	friend class UUASAimAssistTargetSubsystem;
+	friend class UUASAimAssistBenchmarkCommandlet;
+	friend class UUASAimAssistReplayCommandlet;
+
 public:
 	UUASAimAssistTargetComponent();
 
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	UFUNCTION(BlueprintCallable, Category = "AimAssistTargetComponent")
 	void Init(UMeshComponent* Mesh);
 
-	TArray<FUASSocketData> GetAimTargetSocketLocations() const;
+	/** Fills OutLocations with the socket locations of the last refresh by UUASAimAssistTargetSubsystem, reusing its allocation. */
+	void GetAimTargetSocketLocations(TArray<FUASSocketData>& OutLocations) const;
+
+	FVector GetAimTargetSocketLocation(int32 SocketIndex) const;
+
+	/** Average socket velocity over the recent socket cache refreshes, zero until two refreshes are recorded. */
+	FVector GetAimTargetSocketVelocity(int32 SocketIndex) const;
 
 	void SetAimAssistTargetActive(bool bValue) { bIsAimAssistActive = bValue; };
 
@@ -40,6 +54,24 @@ public:
 	UMeshComponent* GetMesh() const;
 
 protected:
+	/** Resolves bone indices for the current socket names and mesh asset, sockets are resolved again whenever either changes. */
+	void ResolveSockets() const;
+
+	bool AreSocketsResolved() const;
+
+	const UObject* GetMeshAsset() const;
+
+	/** Called by UUASAimAssistTargetSubsystem once per frame after animation, reads never refresh the cache. */
+	void RefreshSocketCache() const;
+
+	bool IsSocketCacheValid() const { return CachedSocketsFrameNumber != MAX_uint64; }
+
+	struct FUASResolvedSocket
+	{
+		int32 BoneIndex = INDEX_NONE;
+		FTransform LocalTransform;
+	};
+
 	UPROPERTY()
 	UMeshComponent* MeshComponent;
 
@@ -48,4 +80,24 @@ protected:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "AimAssistTargetComponent")
 	TArray<FName> AimTargetSocketNames;
+
+	int32 RegistryIndex = INDEX_NONE;
+
+	UPROPERTY()
+	USkinnedMeshComponent* SkinnedMeshComponent;
+
+	mutable TArray<FUASResolvedSocket> ResolvedSockets;
+	mutable TArray<FName> ResolvedSocketNames;
+	mutable TWeakObjectPtr<const UObject> ResolvedMeshAsset;
+
+	mutable TArray<FUASSocketData> CachedSockets;
+	mutable uint64 CachedSocketsFrameNumber = MAX_uint64;
+
+	static constexpr int32 VelocityHistorySize = 8;
+
+	/** Ring of VelocityHistorySize socket cache snapshots, snapshot i holds one location per socket. */
+	mutable TArray<FVector> LocationHistory;
+	mutable double HistoryTimes[VelocityHistorySize] = {};
+	mutable int32 HistoryHead = 0;
+	mutable int32 NumHistorySamples = 0;
 };
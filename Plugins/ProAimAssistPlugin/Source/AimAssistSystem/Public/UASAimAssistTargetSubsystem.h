@@ -0,0 +1,126 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UASAimAssistComponent.h"
+
+#include "UASAimAssistTargetSubsystem.generated.h"
+
+class UUASAimAssistTargetComponent;
+
+/** One obstacle check ray of the shared refresh pass. */
+struct FUASVisibilityTrace
+{
+	FVector Start;
+	FVector End;
+	FUASAimAssistTargetData TargetData;
+	TWeakObjectPtr<AActor> TargetActor;
+	int32 ViewIndex = INDEX_NONE;
+	int32 TableRow = INDEX_NONE;
+	FTraceHandle Handle;
+	bool bVisible = false;
+	bool bPending = false;
+
+	/** Re-validates the held target of the view instead of a table row. */
+	bool bValidation = false;
+};
+
+/**
+ * Registry of all aim assist targets in the world.
+ * Targets are inserted into every cell of a uniform grid their mesh and socket bounds overlap, once per frame only the targets
+ * that changed cells are moved in the grid.
+ * Aim assist components register as views, every view that requested a refresh during the frame is served by one shared
+ * pass: the grid and socket caches are built once and all obstacle checks are issued as a single batch.
+ */
+UCLASS()
+class AIMASSISTSYSTEM_API UUASAimAssistTargetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterTarget(UUASAimAssistTargetComponent* Target);
+	void UnregisterTarget(UUASAimAssistTargetComponent* Target);
+
+	/** Changes every time a target is registered or unregistered. */
+	uint32 GetTargetsGeneration() const { return TargetsGeneration; }
+
+	void RegisterView(UUASAimAssistComponent* View);
+	void UnregisterView(UUASAimAssistComponent* View);
+
+	/** Gathers active targets whose bounds intersect the oriented box. */
+	void QueryTargets(const FVector& Location, const FQuat& Rotation, const FVector& Extents, const AActor* IgnoredActor, TArray<UUASAimAssistTargetComponent*>& OutTargets);
+
+protected:
+	/** Caches the socket locations of every active target, tickable objects run after the tick groups so poses are final. */
+	void RefreshTargetSockets();
+
+	void RefreshViews();
+
+	void TraceVisibility();
+
+	void OnVisibilityTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	void ResolveVisibility();
+
+	/** Grid state of the target at the same index of Targets. */
+	struct FTargetEntry
+	{
+		FSphere Bounds = FSphere(ForceInit);
+		FIntVector MinCell = FIntVector::ZeroValue;
+		FIntVector MaxCell = FIntVector::ZeroValue;
+
+		/** Last query that gathered the target, a target spanning several cells is gathered once. */
+		uint32 QueryStamp = 0;
+		bool bInGrid = false;
+	};
+
+	void UpdateGrid();
+
+	void AddToGrid(int32 TargetIndex);
+
+	void RemoveFromGrid(int32 TargetIndex);
+
+	void RemoveTargetAt(int32 TargetIndex);
+
+	/** Mesh bounds grown by the cached sockets, a socket outside the mesh bounds still has to be found by the query. */
+	static FBox GetTargetBox(const UUASAimAssistTargetComponent& Target);
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	static uint64 PackCell(const FIntVector& Cell);
+
+	/** Cell coordinates are packed into 21 bits per axis, [-MaxPackedCell, MaxPackedCell). */
+	static constexpr int32 MaxPackedCell = 1 << 20;
+
+	/** Entries are nulled by garbage collection when a target is destroyed without EndPlay, UpdateGrid drops them. */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UUASAimAssistTargetComponent>> Targets;
+
+	UPROPERTY(Transient)
+	TArray<UUASAimAssistComponent*> Views;
+
+	TArray<TWeakObjectPtr<UUASAimAssistComponent>> PassViews;
+
+	/** False for views that only joined the pass to validate their held target. */
+	TArray<bool> PassViewsRefreshed;
+	TArray<FUASVisibilityTrace> VisibilityTraces;
+	int32 NumPendingVisibilityTraces = 0;
+
+	/** Frame the current obstacle check batch was issued on, batches older than AimAssist.MaxPendingTraceFrames are given up. */
+	uint64 VisibilityBatchFrame = 0;
+	FTraceDelegate VisibilityTraceDelegate;
+
+	TArray<FTargetEntry> TargetEntries;
+	TMap<uint64, TArray<int32>> GridCells;
+
+	uint32 TargetsGeneration = 0;
+	uint32 QueryStamp = 0;
+
+	float CellSize = 0.f;
+	uint64 GridFrameNumber = MAX_uint64;
+};
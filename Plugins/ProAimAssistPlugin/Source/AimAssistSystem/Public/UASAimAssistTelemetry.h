@@ -0,0 +1,85 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+class IFileHandle;
+
+/** One evaluated frame of a local aim assist view. */
+struct AIMASSISTSYSTEM_API FUASAimAssistTelemetryFrame
+{
+public:
+	void Reset();
+
+	friend FArchive& operator<<(FArchive& Ar, FUASAimAssistTelemetryFrame& Frame);
+
+	double Time = 0.0;
+	float DeltaTime = 0.f;
+
+	/** The view requested a target refresh during the frame, replays refresh on the same frames. */
+	bool bTargetsRefreshed = false;
+
+	FVector CameraLocation = FVector::ZeroVector;
+	FRotator CameraRotation = FRotator::ZeroRotator;
+	FRotator ControlRotation = FRotator::ZeroRotator;
+
+	FMatrix ViewProjectionMatrix = FMatrix::Identity;
+	FIntRect ViewRect;
+
+	/** Visible candidate sockets of the frame, CurrentCandidate indexes into them. */
+	TArray<FVector> CandidateLocations;
+	TArray<FVector2D> CandidateScreenLocations;
+
+	/** Target component unique id in the high bits and socket index in the low bits, stable across frames while the target lives. */
+	TArray<uint64> CandidateIds;
+	int32 CurrentCandidate = INDEX_NONE;
+
+	/** EUASAimAssistFeatures bits of the zones the current target is in. */
+	uint8 ActiveZones = 0;
+
+	float PitchMultiplier = 1.f;
+	float YawMultiplier = 1.f;
+	FVector2D CrosshairPosition = FVector2D::ZeroVector;
+};
+
+/**
+ * Serializes telemetry frames into a ring of fixed size chunks, full chunks are appended to the file on worker tasks.
+ * Frames arriving while every chunk waits for its write are dropped instead of stalling the game thread.
+ */
+class AIMASSISTSYSTEM_API FUASAimAssistTelemetryRecorder
+{
+public:
+	~FUASAimAssistTelemetryRecorder();
+
+	bool Start(const FString& FilePath);
+
+	void Record(FUASAimAssistTelemetryFrame& Frame);
+
+	void Stop();
+
+	bool IsRecording() const { return FileHandle.IsValid(); }
+
+	int32 GetNumDroppedFrames() const { return NumDroppedFrames; }
+
+	static bool Load(const FString& FilePath, TArray<FUASAimAssistTelemetryFrame>& OutFrames);
+
+protected:
+	void Flush();
+
+	static constexpr uint32 FileMagic = 0x54534155;
+	static constexpr int32 FileVersion = 3;
+	static constexpr int32 NumChunks = 4;
+	static constexpr int32 ChunkSize = 64 * 1024;
+
+	TArray<uint8> Chunks[NumChunks];
+	UE::Tasks::FTask ChunkWriteTasks[NumChunks];
+	int32 CurrentChunk = 0;
+
+	/** Last launched write, every write waits for the previous one so chunks land in order. */
+	UE::Tasks::FTask WriteTask;
+
+	TUniquePtr<IFileHandle> FileHandle;
+	int32 NumDroppedFrames = 0;
+};
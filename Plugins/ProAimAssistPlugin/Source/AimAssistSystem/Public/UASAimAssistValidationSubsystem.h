@@ -0,0 +1,94 @@
+﻿// Copyright 2022 Dmitriy Vergasov All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tasks/Task.h"
+#include "UASAimAssistTargetComponent.h"
+
+#include "UASAimAssistValidationSubsystem.generated.h"
+
+class APlayerController;
+class UUASAimAssistConfigDataAsset;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FUASOnAimAssistDivergenceDelegate, APlayerController*, Player, float, Score);
+
+/**
+ * Server side sanity check of client aim assist.
+ * Every frame the replicated view of each player is matched against the registered targets, when the view converges on a
+ * target inside the auto aim zone faster than the player's config allows the frame counts as divergent. Magnetism only pulls
+ * the crosshair, so inside its zone the view may not snap further than the magnetism aim radius in one frame. All players are
+ * evaluated by one task that runs alongside the rest of the frame, results are applied at the start of the next tick.
+ * A frame only counts as divergent once the view kept converging too fast for AimAssist.ServerValidation.MinConsecutiveFrames
+ * frames in a row, a manual flick snaps the view once while assisted aim keeps pulling. The score is the share of divergent
+ * frames among the in-zone frames of a sliding window, it is a signal for review rather than proof.
+ *
+ * Only players whose UUASAimAssistComponent lives on the player controller are checked, the server judges a player by the
+ * config its client reported with ServerReportDataAsset. Players that never reported one are skipped and logged.
+ */
+UCLASS()
+class AIMASSISTSYSTEM_API UUASAimAssistValidationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+
+	UPROPERTY(BlueprintAssignable, Category = "AimAssistValidation")
+	FUASOnAimAssistDivergenceDelegate OnAimAssistDivergenceDelegate;
+
+protected:
+	struct FPlayerState
+	{
+		int32 LastTargetIndex = INDEX_NONE;
+		float LastTargetAngle = 0.f;
+		int32 NumSamples = 0;
+		int32 NumDivergentSamples = 0;
+		int32 NumConsecutiveDivergentSamples = 0;
+		float Score = 0.f;
+		bool bFlagged = false;
+		bool bMissingConfigLogged = false;
+	};
+
+	struct FPlayerInput
+	{
+		FPlayerState* State = nullptr;
+		FVector ViewLocation;
+		FVector ViewDirection;
+		float DeltaTime = 0.f;
+		float AutoAimZoneAngle = 0.f;
+		float MagnetismStartAngle = 0.f;
+		float MagnetismAimAngle = 0.f;
+		float ActivationDistanceSquared = 0.f;
+		float AutoAimSpeed = 0.f;
+		bool bAutoAimOnlyWithInactiveMagnetism = false;
+		float Tolerance = 0.f;
+		float Threshold = 0.f;
+		int32 WindowSize = 0;
+		int32 MinConsecutiveFrames = 1;
+		int32 FirstCandidate = 0;
+		int32 NumCandidates = 0;
+	};
+
+	void ApplyResults();
+
+	void GatherInputs(float DeltaTime);
+
+	static void EvaluatePlayer(const FPlayerInput& Input, TConstArrayView<FVector> CandidateLocations, TConstArrayView<int32> CandidateTargets);
+
+	UUASAimAssistConfigDataAsset* FindConfig(APlayerController* Player) const;
+
+	TMap<TWeakObjectPtr<APlayerController>, FPlayerState> PlayerStates;
+
+	TArray<FPlayerInput> Inputs;
+	TArray<TWeakObjectPtr<APlayerController>> InputPlayers;
+	TArray<FVector> CandidateLocations;
+	TArray<int32> CandidateTargets;
+	TArray<UUASAimAssistTargetComponent*> QueriedTargets;
+	TArray<FUASSocketData> SocketLocations;
+
+	UE::Tasks::FTask EvaluationTask;
+};